@@ -0,0 +1,311 @@
+#include <vector>
+#include <string>
+#include <chrono>
+#include <random>
+#include <functional>
+#include <algorithm>
+#include <iostream>
+#include <math.h>
+
+#include <Delaunay.hpp>
+#include <Mesh.hpp>
+
+// Benchmark suite: every case is printed as one JSON object per line
+//
+// Usage: trimesh_bench [--min N] [--max N] [--max-mesh N] [--repeat R] [--filter text]
+
+struct Options {
+    long min_size{1000};
+    long max_size{1000000};
+    // Limit of the refinement and meshing cases
+    long max_mesh_size{1000000};
+    int repeat{3};
+    std::string filter{};
+};
+
+struct Result {
+    std::string name;
+    long size;
+    std::vector<double> times;
+    long nodes;
+    long triangles;
+};
+
+// Point sets (fixed seeds so that runs are comparable)
+std::vector<Coord2D> uniform_points(long n) {
+    std::mt19937 gen{1};
+    std::uniform_real_distribution<double> u{0, 1};
+    std::vector<Coord2D> points;
+    points.reserve(n);
+    for(long i{0}; i < n; i++) {
+        double x{u(gen)};
+        points.emplace_back(x, u(gen));
+    }
+    return points;
+}
+
+std::vector<Coord2D> clustered_points(long n) {
+    std::mt19937 gen{2};
+    std::uniform_real_distribution<double> u{0, 1};
+    std::normal_distribution<double> g{0, 0.01};
+    int clusters{20};
+    std::vector<Coord2D> centers;
+    for(int i{0}; i < clusters; i++) {
+        double x{u(gen)};
+        centers.emplace_back(x, u(gen));
+    }
+    std::vector<Coord2D> points;
+    points.reserve(n);
+    for(long i{0}; i < n; i++) {
+        const Coord2D& c = centers[i % clusters];
+        double x{c.x + g(gen)};
+        points.emplace_back(x, c.y + g(gen));
+    }
+    return points;
+}
+
+// Regular grid: every cell has four cocircular nodes
+std::vector<Coord2D> grid_points(long n) {
+    long side{static_cast<long>(std::ceil(std::sqrt(static_cast<double>(n))))};
+    std::vector<Coord2D> points;
+    points.reserve(n);
+    for(long i{0}; i < n; i++) {
+        points.emplace_back(static_cast<double>(i % side) / side, static_cast<double>(i / side) / side);
+    }
+    return points;
+}
+
+// Most points lie on a few horizontal, vertical and diagonal lines
+std::vector<Coord2D> collinear_points(long n) {
+    std::mt19937 gen{3};
+    std::uniform_real_distribution<double> u{0, 1};
+    std::vector<Coord2D> points;
+    points.reserve(n);
+    int lines{8};
+    for(long i{0}; i < n; i++) {
+        double s{u(gen)};
+        double k{static_cast<double>(i % lines + 1) / (lines + 1)};
+        switch(i % 10) {
+            case 0: points.emplace_back(s, u(gen)); break;
+            case 1: case 2: case 3: points.emplace_back(s, k); break;
+            case 4: case 5: case 6: points.emplace_back(k, s); break;
+            default: points.emplace_back(s, s); break;
+        }
+    }
+    return points;
+}
+
+// Domains of TestMesh.cpp, boundary spacing h
+Boundary cylinder_domain(double h) {
+    double Lx{10};
+    double Ly{5};
+    auto wall1 = Boundary::line(Coord2D{-Lx/2, -Ly/2}, Coord2D{Lx/2, -Ly/2}, h);
+    auto wall2 = Boundary::line(Coord2D{-Lx/2, Ly/2}, Coord2D{Lx/2, Ly/2}, h);
+    auto inlet = Boundary::line(Coord2D{-Lx/2, -Ly/2}, Coord2D{-Lx/2, Ly/2}, h);
+    auto outlet = Boundary::line(Coord2D{Lx/2, -Ly/2}, Coord2D{Lx/2, Ly/2}, h);
+    auto cylinder = Boundary::circle(Coord2D{0, 0}, 1, std::min(h, 0.2));
+    return Boundary::combine(inlet, wall1, outlet, wall2, cylinder);
+}
+
+Boundary naca_domain(double h) {
+    double Lx{5};
+    double Ly{2.5};
+    auto wall1 = Boundary::line(Coord2D{-Lx/2, -Ly/2}, Coord2D{Lx/2, -Ly/2}, h);
+    auto wall2 = Boundary::line(Coord2D{-Lx/2, Ly/2}, Coord2D{Lx/2, Ly/2}, h);
+    auto inlet = Boundary::line(Coord2D{-Lx/2, -Ly/2}, Coord2D{-Lx/2, Ly/2}, h);
+    auto outlet = Boundary::line(Coord2D{Lx/2, -Ly/2}, Coord2D{Lx/2, Ly/2}, h);
+    auto airfoil = Boundary::naca("2412", 1);
+    return Boundary::combine(inlet, wall1, outlet, wall2, airfoil);
+}
+
+// Element size giving roughly n triangles over a domain of the given area
+double element_size(double domain_area, long n) {
+    return std::sqrt(3 * domain_area / n);
+}
+
+// Run a case several times, the setup is not timed
+Result run(const std::string& name, long size, int repeat,
+           std::function<void()> setup, std::function<std::pair<long, long>()> body) {
+    Result result{name, size, {}, 0, 0};
+    for(int r{0}; r < repeat; r++) {
+        setup();
+        auto start = std::chrono::steady_clock::now();
+        auto counts = body();
+        auto end = std::chrono::steady_clock::now();
+        result.times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+        result.nodes = counts.first;
+        result.triangles = counts.second;
+    }
+    return result;
+}
+
+void print(const Result& result) {
+    std::vector<double> times{result.times};
+    std::sort(times.begin(), times.end());
+    double mean{0};
+    for(double t: times) {
+        mean += t;
+    }
+    mean /= times.size();
+    std::cout << "{\"case\": \"" << result.name << "\""
+              << ", \"size\": " << result.size
+              << ", \"nodes\": " << result.nodes
+              << ", \"triangles\": " << result.triangles
+              << ", \"repeat\": " << times.size()
+              << ", \"min_ms\": " << times.front()
+              << ", \"median_ms\": " << times[times.size()/2]
+              << ", \"mean_ms\": " << mean
+              << ", \"max_ms\": " << times.back()
+              << "}" << std::endl;
+}
+
+Options parse(int argc, char* argv[]) {
+    Options options;
+    for(int i{1}; i < argc; i++) {
+        std::string arg{argv[i]};
+        if(i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << std::endl;
+            std::exit(1);
+        }
+        std::string value{argv[++i]};
+        if(arg == "--min") {
+            options.min_size = static_cast<long>(std::stod(value));
+        } else if(arg == "--max") {
+            options.max_size = static_cast<long>(std::stod(value));
+        } else if(arg == "--max-mesh") {
+            options.max_mesh_size = static_cast<long>(std::stod(value));
+        } else if(arg == "--repeat") {
+            options.repeat = std::max(1, std::stoi(value));
+        } else if(arg == "--filter") {
+            options.filter = value;
+        } else {
+            std::cerr << "Unknown option " << arg << std::endl;
+            std::exit(1);
+        }
+    }
+    return options;
+}
+
+int main(int argc, char* argv[]) {
+    Options options{parse(argc, argv)};
+    auto selected = [&](const std::string& name) {
+        return name.find(options.filter) != std::string::npos;
+    };
+
+    std::vector<long> sizes;
+    for(long n{1000}; n <= 1000000; n *= 10) {
+        if(n >= options.min_size && n <= options.max_size) {
+            sizes.push_back(n);
+        }
+    }
+
+    // Delaunay triangulation of point sets
+    std::vector<std::pair<std::string, std::function<std::vector<Coord2D>(long)>>> point_sets{
+        {"uniform", uniform_points},
+        {"clustered", clustered_points},
+        {"grid", grid_points},
+        {"collinear", collinear_points}
+    };
+    for(auto& [set_name, generate]: point_sets) {
+        for(long n: sizes) {
+            std::vector<Coord2D> points{generate(n)};
+            Delaunay d;
+            std::string name{"compute/" + set_name};
+            if(selected(name)) {
+                print(run(name, n, options.repeat, [&]() { d = Delaunay{points}; }, [&]() {
+                    d.compute();
+                    return std::pair<long, long>(d.get_nodes_count(), d.get_triangles_view().size());
+                }));
+            }
+            name = "compute_lawson/" + set_name;
+            if(selected(name)) {
+                print(run(name, n, options.repeat, [&]() { d = Delaunay{points, Engine::lawson}; }, [&]() {
+                    d.compute();
+                    return std::pair<long, long>(d.get_nodes_count(), d.get_triangles_view().size());
+                }));
+            }
+            name = "compute_parallel/" + set_name;
+            if(selected(name)) {
+                print(run(name, n, options.repeat, [&]() { d = Delaunay{points}; }, [&]() {
+                    d.compute_parallel();
+                    return std::pair<long, long>(d.get_nodes_count(), d.get_triangles_view().size());
+                }));
+            }
+            // Batch of n/10 points added to the existing triangulation
+            name = "add_points/" + set_name;
+            if(selected(name)) {
+                std::vector<Coord2D> batch{generate(n/10)};
+                for(Coord2D& p: batch) {
+                    p.x = 0.25 + 0.5*p.x;
+                    p.y = 0.25 + 0.5*p.y;
+                }
+                print(run(name, n, options.repeat, [&]() { d = Delaunay{points}; d.compute(); }, [&]() {
+                    d.add_points(batch);
+                    return std::pair<long, long>(d.get_nodes_count(), d.get_triangles_view().size());
+                }));
+            }
+        }
+    }
+
+    // Refinement and meshing of the test domains, sizes are approximate numbers of triangles
+    std::vector<std::tuple<std::string, std::function<Boundary(double)>, double>> domains{
+        {"cylinder", cylinder_domain, 10*5 - M_PI},
+        {"naca2412", naca_domain, 5*2.5}
+    };
+    for(auto& [domain_name, domain, domain_area]: domains) {
+        for(long n: sizes) {
+            if(n > options.max_mesh_size) {
+                break;
+            }
+            double h{element_size(domain_area, n)};
+            Boundary boundary{domain(h)};
+            std::vector<Coord2D> points;
+            for(Node& node: boundary.get_nodes()) {
+                points.push_back(node.get_coords());
+            }
+            Delaunay d;
+            std::string name{"refine/" + domain_name};
+            if(selected(name)) {
+                print(run(name, n, options.repeat, [&]() { d = Delaunay{points}; d.compute(); }, [&]() {
+                    d.refine(30 * M_PI / 180, h);
+                    return std::pair<long, long>(d.get_nodes_count(), d.get_triangles_view().size());
+                }));
+            }
+            name = "refine_parallel/" + domain_name;
+            if(selected(name)) {
+                print(run(name, n, options.repeat, [&]() { d = Delaunay{points}; d.compute(); }, [&]() {
+                    d.refine(30 * M_PI / 180, h, 0);
+                    return std::pair<long, long>(d.get_nodes_count(), d.get_triangles_view().size());
+                }));
+            }
+            // Quality and size sweeps over the refined mesh
+            name = "quality/" + domain_name;
+            if(selected(name)) {
+                print(run(name, n, options.repeat, [&]() { d = Delaunay{points}; d.compute(); d.refine(30 * M_PI / 180, h); }, [&]() {
+                    long bad{static_cast<long>(d.get_bad_triangles(33 * M_PI / 180).size())};
+                    long big{static_cast<long>(d.get_big_triangles(2 * h).size())};
+                    return std::pair<long, long>(bad, big);
+                }));
+            }
+            name = "mesh/" + domain_name;
+            if(selected(name)) {
+                print(run(name, n, options.repeat, []() {}, [&]() {
+                    Mesh mesh{boundary, h};
+                    const Delaunay& result{mesh.get_triangulation()};
+                    return std::pair<long, long>(result.get_nodes_count(), result.get_triangles_view().size());
+                }));
+            }
+            // Same boundary, element size graded from the boundary segments up to 20h
+            name = "mesh_graded/" + domain_name;
+            if(selected(name)) {
+                print(run(name, n, options.repeat, []() {}, [&]() {
+                    Mesh mesh{boundary, BoundarySizeField{boundary, 20 * h}};
+                    const Delaunay& result{mesh.get_triangulation()};
+                    return std::pair<long, long>(result.get_nodes_count(), result.get_triangles_view().size());
+                }));
+            }
+        }
+    }
+
+    return 0;
+}
@@ -5,8 +5,42 @@
 #include <cmath>
 #include <array>
 #include <set>
+#include <unordered_map>
+#include <numeric>
+#include <random>
+#include <cstdint>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <queue>
+#include <functional>
+#include <fstream>
+#include <cstring>
+#include <iterator>
 
 #include <Delaunay.hpp>
+#include <Predicates.hpp>
+#include <MeshFile.hpp>
+#include <Stats.hpp>
+#include <Kernels.hpp>
+
+#ifdef TRIMESH_ENABLE_STATS
+// Predicate evaluations of the calling thread during the lifetime of the scope are added to the stats
+// (worker threads open their own scope and their stats are added after join)
+class PredicateScope {
+    Stats& stats;
+    Predicates::Counts start;
+public:
+    PredicateScope(Stats& stats) : stats{stats}, start{Predicates::counts()} {}
+    ~PredicateScope() {
+        Predicates::Counts end{Predicates::counts()};
+        stats.orient2d += end.orient2d - start.orient2d;
+        stats.incircle += end.incircle - start.incircle;
+        stats.exact += end.exact - start.exact;
+        stats.circle_tests += end.circle_tests - start.circle_tests;
+    }
+};
+#endif
 
 
 // Coord2D constructors
@@ -98,6 +132,69 @@ double slope(const Coord2D& p1, const Coord2D& p2) {
     return (p2.y - p1.y) / (p2.x - p1.x);
 }
 
+// Position along a Hilbert curve of order 16 of a point with integer coordinates
+static uint64_t hilbert_index(uint32_t x, uint32_t y) {
+    const uint32_t n{1u << 16};
+    uint64_t d{0};
+    for(uint32_t s{n >> 1}; s > 0; s >>= 1) {
+        uint32_t rx{(x & s) ? 1u : 0u};
+        uint32_t ry{(y & s) ? 1u : 0u};
+        d += static_cast<uint64_t>(s) * s * ((3 * rx) ^ ry);
+        // Rotate quadrant
+        if(ry == 0) {
+            if(rx == 1) {
+                x = n - 1 - x;
+                y = n - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return d;
+}
+
+// Biased randomized insertion order (BRIO): points are split in rounds of doubling size
+// and every round is sorted along a Hilbert curve, so consecutive points are close
+std::vector<int> spatial_order(const std::vector<Coord2D>& points) {
+    int n{static_cast<int>(points.size())};
+    std::vector<int> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    if(n < 3) {
+        return order;
+    }
+
+    // Bounding box used to quantize coordinates
+    double min_x{points[0].x}, max_x{points[0].x};
+    double min_y{points[0].y}, max_y{points[0].y};
+    for(const Coord2D& p: points) {
+        min_x = std::min(min_x, p.x);
+        max_x = std::max(max_x, p.x);
+        min_y = std::min(min_y, p.y);
+        max_y = std::max(max_y, p.y);
+    }
+    double size{std::max(max_x - min_x, max_y - min_y)};
+    double scale{(size > 0) ? 65535 / size : 0};
+
+    std::vector<uint64_t> keys(n);
+    for(int i{0}; i < n; i++) {
+        uint32_t x{static_cast<uint32_t>((points[i].x - min_x) * scale)};
+        uint32_t y{static_cast<uint32_t>((points[i].y - min_y) * scale)};
+        keys[i] = hilbert_index(x, y);
+    }
+
+    // Fixed seed keeps the triangulation reproducible
+    std::mt19937 generator{0};
+    std::shuffle(order.begin(), order.end(), generator);
+
+    // Last round holds half of the points, the previous one a quarter and so on
+    int end{n};
+    while(end > 0) {
+        int begin{(end > 64) ? end / 2 : 0};
+        std::sort(order.begin() + begin, order.begin() + end, [&keys](int a, int b) { return keys[a] < keys[b]; });
+        end = begin;
+    }
+    return order;
+}
+
 // Edge constructors
 Edge::Edge() {
 }
@@ -216,36 +313,53 @@ std::array<std::array<int, 2>, 3> Triangle::get_edges_index() const {
     };
 }
 
-// Compute triangle circumcenter based on intersection of two heights
-Coord2D Triangle::circumcenter() {
-    Coord2D v1 = data[0].get_coords();
-    Coord2D v2 = data[1].get_coords();
-    Coord2D v3 = data[2].get_coords();
+// Compute triangle circumcenter solving the perpendicular bisectors equations relative to one vertex
+Coord2D circumcenter(const Coord2D& v1, const Coord2D& v2, const Coord2D& v3) {
+    // Translate vertices so that v1 lies on the origin
+    double bx{v2.x - v1.x}, by{v2.y - v1.y};
+    double cx{v3.x - v1.x}, cy{v3.y - v1.y};
+    double b2{bx*bx + by*by};
+    double c2{cx*cx + cy*cy};
 
-    // Compute triangle midpoints
-    Coord2D p1 = midpoint(v2, v3);
-    Coord2D p2 = midpoint(v3, v1);
-    Coord2D p3 = midpoint(v1, v2);
+    // Twice the signed area (zero for degenerate triangles)
+    double d{2 * (bx*cy - by*cx)};
 
-    // Compute the slope of two of the heights (perpendicular to edge slope)
-    double m1 = -1 / slope(v2, v3);
-    double m2 = -1 / slope(v3, v1);
-    double m3 = -1 / slope(v1, v2);
+    return Coord2D{v1.x + (cy*b2 - by*c2) / d, v1.y + (bx*c2 - cx*b2) / d};
+}
 
-    // Checking for vertical lines
-    if(std::isinf(m1)) {
-        m1 = m3;
-        p1 = p3;
-    } else if(std::isinf(m2)) {
-        m2 = m3;
-        p2 = p3;
-    }
+// Check if point is inside the circumcircle (exact predicates, vertices may be in any order)
+bool in_circumcircle(const Coord2D& a, const Coord2D& b, const Coord2D& c, const Coord2D& p) {
+    // Incircle sign is reversed for clockwise triangles
+    double orientation{Predicates::orient2d(a, b, c)};
+    double incircle{Predicates::incircle(a, b, c, p)};
 
-    // Solve for lines intersection
-    double x = ( (p2.y - m2*p2.x) - (p1.y - m1*p1.x) ) / (m1 - m2);
-    double y = m1 * (x - p1.x) + p1.y;
+    return (orientation > 0) ? incircle > 0 : incircle < 0;
+}
 
-    return Coord2D{x, y};
+// Lowest inner angle of a triangle
+double min_angle(const Coord2D& v1, const Coord2D& v2, const Coord2D& v3) {
+    // Compute length of triangle edges
+    std::array<double, 3> sides{dist(v1, v2), dist(v2, v3), dist(v1, v3)};
+
+    // Sort edges length
+    std::sort(sides.begin(), sides.end());
+
+    // Get edges
+    double a = sides[0];
+    double b = sides[1];
+    double c = sides[2];
+    
+    // Apply cosine theorem: A is opposite angle to smallest side
+    return acos((b*b + c*c - a*a) / (2*b*c));
+}
+
+// Triangle area from the cross product of two edges
+double area(const Coord2D& v1, const Coord2D& v2, const Coord2D& v3) {
+    return 0.5 * std::abs((v2.x - v1.x)*(v3.y - v1.y) - (v2.y - v1.y)*(v3.x - v1.x));
+}
+
+Coord2D Triangle::circumcenter() {
+    return ::circumcenter(data[0].get_coords(), data[1].get_coords(), data[2].get_coords());
 }
 
 // Compute triangle centroid
@@ -265,97 +379,182 @@ Coord2D Triangle::centroid() {
 
 // Check if node is inside triangle circumcircle
 bool Triangle::circumscribe(Node& n) {
+    return in_circumcircle(data[0].get_coords(), data[1].get_coords(), data[2].get_coords(), n.get_coords());
+}
+
+// Compute triangle quality (lowest inner angle)
+double Triangle::get_alpha() {
+    return min_angle(data[0].get_coords(), data[1].get_coords(), data[2].get_coords());
+}
 
-    // Compute circumcenter
-    Coord2D circum_center{circumcenter()};
+// Compute triangle area
+double Triangle::get_area() {
+    return area(data[0].get_coords(), data[1].get_coords(), data[2].get_coords());
+}
 
-    // Compute circum radiues
-    double circum_radius{dist(circum_center, data[0].get_coords())};
+// Delaunay constructors
+Delaunay::Delaunay() {};
 
-    // Get distance from node to circumcenter
-    double distance{dist(circum_center, n.get_coords())};
+Delaunay::Delaunay(Engine engine) : engine{engine} {}
 
-    // Node inside condition
-    return distance < circum_radius;    
+Delaunay::Delaunay(std::vector<Coord2D> points, Engine engine) : engine{engine} {
+    xs.reserve(points.size() + 3);
+    ys.reserve(points.size() + 3);
+    for(Coord2D &point: points) {
+        xs.push_back(point.x);
+        ys.push_back(point.y);
+    }
 }
 
-// Compute triangle quality
-double Triangle::get_alpha() {
-    // Compute length of triangle edges
-    std::vector<double> sides(edges.size());
-    std::transform(edges.begin(), edges.end(), sides.begin(), [](Edge& edge) { return edge.length(); });
+// Constrained mode: segments are recovered as edges of the triangulation and the triangles outside
+// the domain they enclose (or inside its holes) are discarded. Segments are matched to nodes by coordinates.
+Delaunay::Delaunay(std::vector<Coord2D> points, std::vector<Edge> segments, Engine engine)
+    : Delaunay{points, engine} {
+    this->segments = segments;
+}
 
-    // Sort edges length
-    std::sort(sides.begin(), sides.end());
+// Constructor for rebuilding a mesh - it allows external triangles/nodes filtering 
+// Nodes are renumbered following their position in the list
+Delaunay::Delaunay(std::vector<Triangle> triangles, std::vector<Node> nodes) {
+    std::unordered_map<int, int> position;
+    for(const Node& node: nodes) {
+        position.emplace(node.get_index(), get_nodes_count());
+        xs.push_back(node.get_x());
+        ys.push_back(node.get_y());
+    }
+    for(const Triangle& triangle: triangles) {
+        std::array<int, 3> v;
+        std::array<Node, 3> vertices{triangle.get_vertices()};
+        for(int k{0}; k < 3; k++) {
+            auto match = position.find(vertices[k].get_index());
+            if(match == position.end()) {
+                // Triangle vertices missing in the list are added
+                match = position.emplace(vertices[k].get_index(), get_nodes_count()).first;
+                xs.push_back(vertices[k].get_x());
+                ys.push_back(vertices[k].get_y());
+            }
+            v[k] = match->second;
+        }
+        std::sort(v.begin(), v.end());
+        this->triangles.push_back(v);
+    }
+    build_neighbors();
+    update_circles();
+}
 
-    // Get edges
-    double a = sides[0];
-    double b = sides[1];
-    double c = sides[2];
-    
-    // Apply cosine theorem
-    double A = acos((b*b + c*c - a*a) / (2*b*c)); // A is opposite angle to smallest side
+Delaunay::~Delaunay() {
+}
 
-    // Return lowest triangle inner angle - A
-    return A;
+// Coordinates of a node (super triangle nodes are negative)
+Coord2D Delaunay::point(int v) const {
+    return Coord2D{xs[v+3], ys[v+3]};
 }
 
-// Compute triangle area
-double Triangle::get_area() {
-    // Compute length of triangle edges
-    std::vector<double> sides(edges.size());
-    std::transform(edges.begin(), edges.end(), sides.begin(), [](Edge& edge) { return edge.length(); });
+// Triangle object of the given position
+Triangle Delaunay::triangle(int t) const {
+    const std::array<int, 3>& v{triangles[t]};
+    return Triangle{Node{point(v[0]), v[0]}, Node{point(v[1]), v[1]}, Node{point(v[2]), v[2]}};
+}
 
-    // Get edges
-    double a = sides[0];
-    double b = sides[1];
-    double c = sides[2];
+// Final triangles do not contain super triangle nodes (negative, sorted first) and lie inside the domain
+bool Delaunay::is_final(int t) const {
+    return triangles[t][0] >= 0 && (exterior.empty() || !exterior[t]);
+}
 
-    // Compute semi-perimeter
-    double s = (a + b + c) / 2;
+// Drop the final triangles cache (every change of triangles or exterior flags must call it)
+void Delaunay::invalidate_final() {
+    cache.final_cached = false;
+    cache.edges_cached = false;
+}
+
+void Delaunay::update_final() const {
+    if(cache.final_cached.load(std::memory_order_acquire)) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock{cache.mutex};
+    if(cache.final_cached.load(std::memory_order_relaxed)) {
+        return;
+    }
+    final_positions.clear();
+    final_triangles.clear();
+    for(size_t t{0}; t < triangles.size(); t++) {
+        if(is_final(t)) {
+            final_positions.push_back(t);
+            final_triangles.push_back(triangles[t]);
+        }
+    }
+    cache.final_cached.store(true, std::memory_order_release);
+}
 
-    // Apply area formula based on sides length
-    return sqrt(s*(s-a)*(s-b)*(s-c));
+void Delaunay::update_edges() const {
+    if(cache.edges_cached.load(std::memory_order_acquire)) {
+        return;
+    }
+    update_final();
+    std::lock_guard<std::mutex> lock{cache.mutex};
+    if(cache.edges_cached.load(std::memory_order_relaxed)) {
+        return;
+    }
+    final_edges.clear();
+    final_edges.reserve(3*final_triangles.size());
+    for(const std::array<int, 3>& v: final_triangles) {
+        final_edges.push_back({v[0], v[1]});
+        final_edges.push_back({v[1], v[2]});
+        final_edges.push_back({v[0], v[2]});
+    }
+    // Shared edges appear twice
+    std::sort(final_edges.begin(), final_edges.end());
+    final_edges.erase(std::unique(final_edges.begin(), final_edges.end()), final_edges.end());
+    cache.edges_cached.store(true, std::memory_order_release);
 }
 
-// Delaunay constructors
-Delaunay::Delaunay() {};
+// Removed triangles are tombstones waiting in the free list (all vertices are -4)
+bool Delaunay::is_removed(int t) const {
+    return triangles[t][0] == -4;
+}
 
-Delaunay::Delaunay(std::vector<Coord2D> points) {
-    int i{};
-    for(Coord2D &point: points) {
-        nodes.emplace_back(point, i++);
+// Slot for a new triangle: a free one if any, otherwise appended (contents are set by the caller)
+int Delaunay::new_slot() {
+    if(!free_slots.empty()) {
+        int t{free_slots.back()};
+        free_slots.pop_back();
+        return t;
     }
+    triangles.emplace_back();
+    neighbors.emplace_back();
+    circles.emplace_back();
+    if(!exterior.empty()) {
+        exterior.push_back(0);
+    }
+    return triangles.size() - 1;
 }
 
-// Constructor for rebuilding a mesh - it allows external triangles/nodes filtering 
-Delaunay::Delaunay(std::vector<Triangle> triangles, std::vector<Node> nodes) 
-: triangles{triangles}, nodes{nodes} {
-    
+// O(1) removal: the slot is unlinked and marked for reuse
+void Delaunay::free_slot(int t) {
+    triangles[t] = {-4, -4, -4};
+    neighbors[t] = {-1, -1, -1};
+    circles[t] = Circumcircle{0, 0, -1, 0};
+    free_slots.push_back(t);
 }
 
-Delaunay::~Delaunay() {
+int Delaunay::get_nodes_count() const {
+    return static_cast<int>(xs.size()) - 3;
 }
 
 // Super triangle computation
-Triangle Delaunay::super_triangle() {
+void Delaunay::super_triangle() {
     // Set dummy limits
     double min_x{std::numeric_limits<double>::infinity()};
     double min_y{std::numeric_limits<double>::infinity()};
     double max_x{-std::numeric_limits<double>::infinity()};
     double max_y{-std::numeric_limits<double>::infinity()};
 
-    double x, y;
-
     // Compute extreme values in x and y
-    for(Node &node: nodes) {
-        x = node.get_coords().x;
-        y = node.get_coords().y;
-
-        max_x = (x > max_x) ? x : max_x;
-        max_y = (y > max_y) ? y : max_y;
-        min_x = (x < min_x) ? x : min_x;
-        min_y = (y < min_y) ? y : min_y;
+    for(size_t i{3}; i < xs.size(); i++) {
+        max_x = std::max(max_x, xs[i]);
+        max_y = std::max(max_y, ys[i]);
+        min_x = std::min(min_x, xs[i]);
+        min_y = std::min(min_y, ys[i]);
     }
 
     // Set a delta with extreme values and outer rect-supertriangle
@@ -368,219 +567,2431 @@ Triangle Delaunay::super_triangle() {
     max_y += 3*dy;
     min_y -= 3*dy;
 
-    // Create supertriangle nodes
-    Node n1{min_x, min_y, -3};
-    Node n2{max_x, min_y, -2};
-    Node n3{(max_x+min_x)*0.5, max_y, -1};
-
-    Triangle outer_nodes{n1, n2, n3};
-
-    return outer_nodes;
+    // Set supertriangle nodes
+    xs[0] = min_x;
+    ys[0] = min_y;
+    xs[1] = max_x;
+    ys[1] = min_y;
+    xs[2] = (max_x+min_x)*0.5;
+    ys[2] = max_y;
 }
 
 Triangle Delaunay::add_point(double x, double y) {
     return add_point(Coord2D{x, y});
 }
 
+// New node is appended to the nodes list even if it cannot be inserted in the triangulation
 Triangle Delaunay::add_point(Coord2D p) {
-    int index = nodes.size();
-    nodes.emplace_back(p, index);
-
-    return add_point(nodes.at(index));
+    TRIMESH_STATS(PredicateScope predicates{stats};)
+    int v{get_nodes_count()};
+    xs.push_back(p.x);
+    ys.push_back(p.y);
+
+    int t{insert(v)};
+    if(t == -1) {
+        // Node was not inserted: return the triangle it lies on
+        t = locate(p);
+        if(t == -1) {
+            throw std::out_of_range("Node lies outside the super triangle");
+        }
+    }
+    return triangle(t);
 }
 
+// Node index is assigned by the triangulation
 Triangle Delaunay::add_point(Node node) {
-    // Instantiate removed triangles vertices
-    std::vector<Edge> edges{};
-    // Loop over all triangles
-    for(size_t i{0}; i<triangles.size(); i++) {
-        auto triangle = triangles.at(i);
-        if(triangle.circumscribe(node)) {
-            // Retrieve edges and add to removed ones
-            auto v = triangle.get_edges();
-            edges.insert(edges.end(), v.begin(), v.end());
-            // Remove triangle because it is no longer Delaunay
-            triangles.erase(std::remove(triangles.begin(), triangles.end(), triangle), triangles.end());
-            i--;
-        }
-    }
-    // Remove duplicated edges (they do not form Delaunay triangules)
-    std::sort(edges.begin(), edges.end());
-    int N{static_cast<int>(edges.size())};
-    Edge edge_to_remove{};
-    for(size_t i{0}; i < (N-1); i++) {
-        if(edges.at(i) == edges.at(i+1)) {
-            edge_to_remove = edges.at(i);
-            edges.erase(std::remove(edges.begin(), edges.end(), edge_to_remove), edges.end());
-            i--;
-            N-=2;
-        }
-    }
-    // Create new triangles
-    for (const Edge& edge: edges) {
-        auto nodes = edge.get_vertices();
-        Node n1 = nodes.at(0);
-        Node n2 = nodes.at(1);
-        triangles.push_back(Triangle{node, n1, n2});
-    }
-}
-
-// Run algorithm
-std::vector<Triangle> Delaunay::compute() {
+    return add_point(node.get_coords());
+}
 
-    // Empty triangles for clean re-computation
-    triangles.clear();
+// Unique key for the edge joining two node indices (super triangle indices are negative)
+long long Delaunay::edge_key(int a, int b) {
+    if(a > b) {
+        std::swap(a, b);
+    }
+    return (static_cast<long long>(a) << 32) ^ static_cast<unsigned int>(b);
+}
 
-    // Compute super triangle
-    triangles.push_back(super_triangle());
+// Nodes of an edge key
+static std::array<int, 2> edge_vertices(long long key) {
+    return {static_cast<int>(key >> 32), static_cast<int>(static_cast<uint32_t>(key))};
+}
 
-    // Loop over all nodes
-    for(Node& node: nodes) {
-        add_point(node);
+// Check if point p lies inside the circle with diameter a-b (p encroaches the segment)
+static bool encroaches(const Coord2D& a, const Coord2D& b, const Coord2D& p) {
+    return (a.x - p.x)*(b.x - p.x) + (a.y - p.y)*(b.y - p.y) < 0;
+}
+
+// Side of the edge a-b where point p lies: positive on the same side as vertex v
+static double side(const Coord2D& a, const Coord2D& b, const Coord2D& v, const Coord2D& p) {
+    double sp{Predicates::orient2d(a, b, p)};
+    double sv{Predicates::orient2d(a, b, v)};
+    return (sp > 0) ? sv : (sp < 0) ? -sv : 0;
+}
+
+// Find the triangle containing the point walking from the last created triangle (-1 if outside)
+int Delaunay::locate(const Coord2D& p) {
+    if(triangles.empty()) {
+        return -1;
+    }
+    int t{(last_triangle >= 0 && last_triangle < static_cast<int>(triangles.size())) ? last_triangle : 0};
+    size_t steps{0};
+    int start{0};
+    while(steps++ <= triangles.size()) {
+        const std::array<int, 3>& v{triangles[t]};
+        int next{t};
+        // Rotate the first checked edge to avoid cycling on degenerate configurations
+        start = (start + 1) % 3;
+        for(int j{0}; j < 3; j++) {
+            int k{(start + j) % 3};
+            // Move across the edge if the point and the opposite vertex lie on different sides
+            if(side(point(v[(k+1)%3]), point(v[(k+2)%3]), point(v[k]), p) < 0) {
+                next = neighbors[t][k];
+                break;
+            }
+        }
+        if(next == t) {
+            TRIMESH_STATS(stats.walks++; stats.walk_steps += steps; stats.max_walk = std::max<long long>(stats.max_walk, steps);)
+            return t;
+        }
+        if(next == -1) {
+            return -1; // point lies outside the super triangle
+        }
+        t = next;
+    }
+
+    // Walk did not converge (non-Delaunay input triangles): fall back to a linear search
+    for(size_t i{0}; i < triangles.size(); i++) {
+        if(is_removed(i)) {
+            continue;
+        }
+        const std::array<int, 3>& v{triangles[i]};
+        bool inside{true};
+        for(int k{0}; k < 3 && inside; k++) {
+            inside = side(point(v[(k+1)%3]), point(v[(k+2)%3]), point(v[k]), p) >= 0;
+        }
+        if(inside) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Triangle containing p reached on a straight line from the centroid of t. Returns -1 if the line
+// crosses a constrained edge (its key is stored in blocking) or leaves the super triangle. The number of
+// triangles visited is stored in steps.
+int Delaunay::walk(int t, const Coord2D& p, long long& blocking, int& steps) const {
+    blocking = -1;
+    steps = 0;
+    const std::array<int, 3>& start{triangles[t]};
+    Coord2D q{(point(start[0]).x + point(start[1]).x + point(start[2]).x) / 3,
+              (point(start[0]).y + point(start[1]).y + point(start[2]).y) / 3};
+    while(static_cast<size_t>(steps++) <= triangles.size()) {
+        const std::array<int, 3>& v{triangles[t]};
+        int exit{-1}, fallback{-1};
+        for(int k{0}; k < 3 && exit == -1; k++) {
+            Coord2D a{point(v[(k+1)%3])}, b{point(v[(k+2)%3])};
+            if(side(a, b, point(v[k]), p) >= 0) {
+                continue;
+            }
+            // Edge crossed by the line q-p (any edge facing p if the line goes through a vertex)
+            double oa{Predicates::orient2d(q, p, a)}, ob{Predicates::orient2d(q, p, b)};
+            if((oa >= 0 && ob <= 0) || (oa <= 0 && ob >= 0)) {
+                exit = k;
+            } else if(fallback == -1) {
+                fallback = k;
+            }
+        }
+        exit = (exit == -1) ? fallback : exit;
+        if(exit == -1) {
+            return t;
+        }
+        if(is_constrained(t, exit)) {
+            blocking = edge_key(v[(exit+1)%3], v[(exit+2)%3]);
+            return -1;
+        }
+        t = neighbors[t][exit];
+        if(t == -1) {
+            return -1;
+        }
+    }
+    return -1;
+}
+
+// Compute and store the circumcircle of the triangle at the given position
+void Delaunay::update_circle(int t) {
+    if(t >= static_cast<int>(circles.size())) {
+        circles.resize(t + 1);
     }
+    const std::array<int, 3>& v{triangles[t]};
+    Coord2D a{point(v[0])}, b{point(v[1])}, c{point(v[2])};
+    Coord2D center{circumcenter(a, b, c)};
+
+    // Error of the computed center grows with the condition number of the 2x2 system
+    // and with the magnitude of the coordinates
+    double eps{std::numeric_limits<double>::epsilon()};
+    double bx{b.x - a.x}, by{b.y - a.y};
+    double cx{c.x - a.x}, cy{c.y - a.y};
+    double condition{(std::abs(bx*cy) + std::abs(by*cx)) / std::abs(bx*cy - by*cx)};
+    double dx{a.x - center.x}, dy{a.y - center.y};
+    double r2{dx*dx + dy*dy};
+    double delta{16 * eps * (condition * std::sqrt(r2) + std::max(std::abs(a.x), std::abs(a.y)))};
+    double error{32 * delta * delta};
+
+    circles[t] = Circumcircle{center.x, center.y, r2, std::isfinite(error) ? error : std::numeric_limits<double>::infinity()};
+}
 
-    // Ensure proper triangles ordering
-    std::sort(triangles.begin(), triangles.end());
+void Delaunay::update_circles() {
+    circles.resize(triangles.size());
+    for(size_t t{0}; t < triangles.size(); t++) {
+        update_circle(t);
+    }
+}
 
-    return triangles;
+// Check if point is inside the circumcircle of the triangle at the given position: the cached
+// circle decides unless the point is too close to it, then exact predicates are used
+bool Delaunay::circumscribe(int t, const Coord2D& p) const {
+    TRIMESH_STATS(Predicates::count_circle_test();)
+    int inside{Kernels::in_circle(circles[t], p)};
+    if(inside != 0) {
+        return inside > 0;
+    }
+    const std::array<int, 3>& v{triangles[t]};
+    return in_circumcircle(point(v[0]), point(v[1]), point(v[2]), p);
 }
 
-// Delaunay getters
-std::vector<Node> Delaunay::get_nodes() const {
-    return nodes;
+// Check if the edge opposite to vertex k of triangle t is constrained
+bool Delaunay::is_constrained(int t, int k) const {
+    return !constraints.empty() && constraints.count(edge_key(triangles[t][(k+1)%3], triangles[t][(k+2)%3])) > 0;
 }
 
-std::vector<Edge> Delaunay::get_edges() const {
-    std::set<Edge> edges;
-    for(const Triangle& triangle: get_triangles()) {
-        auto triangle_edges = triangle.get_edges();
-        edges.insert(triangle_edges.begin(), triangle_edges.end());
+// Cavity of p: non-Delaunay triangles (circumcircle contains p) grown over neighbors from the
+// triangle containing p, without crossing constrained edges
+void Delaunay::find_cavity(int first, const Coord2D& p, std::vector<int>& cavity) {
+    marks.resize(triangles.size(), 0);
+    stamp++;
+    cavity.assign(1, first);
+    marks[first] = stamp;
+    for(size_t i{0}; i < cavity.size(); i++) {
+        int t{cavity[i]};
+        for(int k{0}; k < 3; k++) {
+            int neighbor{neighbors[t][k]};
+            if(neighbor != -1 && marks[neighbor] != stamp && !is_constrained(t, k) && circumscribe(neighbor, p)) {
+                marks[neighbor] = stamp;
+                cavity.push_back(neighbor);
+            }
+        }
     }
-    std::vector<Edge> sorted_edges(edges.begin(), edges.end());
-    std::sort(sorted_edges.begin(), sorted_edges.end());
-    return sorted_edges;
 }
 
-std::vector<std::array<int, 2>> Delaunay::get_edges_index() const {
-    std::vector<std::array<int, 2>> edges_index;
-    for(const Edge& edge: get_edges()) {
-        edges_index.push_back(edge.get_vertices_index());
+// Same cavity as find_cavity without visit marks (safe for concurrent calls)
+void Delaunay::collect_cavity(int first, const Coord2D& p, std::vector<int>& cavity) const {
+    cavity.assign(1, first);
+    for(size_t i{0}; i < cavity.size(); i++) {
+        int t{cavity[i]};
+        for(int k{0}; k < 3; k++) {
+            int neighbor{neighbors[t][k]};
+            if(neighbor != -1 && !is_constrained(t, k) && std::find(cavity.begin(), cavity.end(), neighbor) == cavity.end()
+               && circumscribe(neighbor, p)) {
+                cavity.push_back(neighbor);
+            }
+        }
     }
-    return edges_index;
 }
 
-std::vector<Triangle> Delaunay::get_triangles() const {
-    
-    std::vector<Triangle> triangle_list = triangles;
-    // Remove super triangle nodes
-    std::array<int, 3> index; // Instantiate variable
-    size_t i{0};
-    while(i < triangle_list.size()) {
-        index = triangle_list[i].get_vertices_index();
-        for(int& j: index) {
-            if(j < 0) { // Supertriangle contains "negative" nodes
-                triangle_list.erase(std::remove(triangle_list.begin(), triangle_list.end(), triangle_list[i--]), triangle_list.end());
-                break;
+// Insert node v (coordinates already stored) in the triangulation: returns one of the
+// created triangles or -1 if the node lies outside the super triangle or on an existing vertex
+int Delaunay::insert(int v) {
+    invalidate_final();
+    Coord2D p{point(v)};
+
+    // Locate the triangle containing the node
+    int first{locate(p)};
+    if(first == -1) {
+        return -1;
+    }
+
+    // Nodes already in the triangulation are not inserted again
+    for(int vertex: triangles[first]) {
+        if(point(vertex) == p) {
+            return -1;
+        }
+    }
+
+    // A node lying on a constrained edge splits it
+    std::array<int, 2> split{-1, -1};
+    for(int k{0}; k < 3; k++) {
+        int a{triangles[first][(k+1)%3]}, b{triangles[first][(k+2)%3]};
+        if(is_constrained(first, k) && Predicates::orient2d(point(a), point(b), p) == 0) {
+            split = {a, b};
+            constraints.erase(edge_key(a, b));
+        }
+    }
+
+    if(engine == Engine::lawson) {
+        int t{insert_flip(v, first)};
+        if(split[0] != -1) {
+            constraints.insert(edge_key(split[0], v));
+            constraints.insert(edge_key(v, split[1]));
+        }
+        return t;
+    }
+
+    // Grow the cavity of non-Delaunay triangles
+    Cavity& cavity{insertion};
+    find_cavity(first, p, cavity.removed);
+    if(record_removed) {
+        for(int t: cavity.removed) {
+            if(is_final(t)) {
+                removed_triangles.push_back(triangles[t]);
             }
         }
-        i++;
-    }   
+    }
 
-    return triangle_list;
+    // Replace it by the triangles joining the node with the cavity boundary
+    find_boundary(cavity, true);
+    cavity.slots.clear();
+    for(size_t i{cavity.removed.size()}; i < cavity.boundary.size(); i++) {
+        cavity.slots.push_back(new_slot());
+    }
+    fill_cavity(v, cavity);
+    TRIMESH_STATS(
+        stats.insertions++;
+        stats.cavity_triangles += cavity.removed.size();
+        stats.max_cavity = std::max<long long>(stats.max_cavity, cavity.removed.size());
+        stats.triangles_created += cavity.created.size();
+        stats.triangles_destroyed += cavity.removed.size();
+    )
+
+    // Cavity slots left over (degenerate cavities) are released
+    for(size_t i{cavity.boundary.size()}; i < cavity.removed.size(); i++) {
+        free_slot(cavity.removed[i]);
+    }
+
+    // Both halves of a split edge remain constrained
+    if(split[0] != -1) {
+        constraints.insert(edge_key(split[0], v));
+        constraints.insert(edge_key(v, split[1]));
+    }
+
+    // Next walk starts from the last modified region
+    last_triangle = cavity.created.front();
+
+    // Return one of the triangles containing the new node
+    return cavity.created.front();
 }
 
-std::vector<std::array<int, 3>> Delaunay::get_triangles_index() const {
-    std::vector<std::array<int, 3>> triangles_index;
-    for(const Triangle& triangle: get_triangles()) {
-        triangles_index.push_back(triangle.get_vertices_index());
-    }
-    return triangles_index;
-}
-
-// Function to get the neighboring triangles to the inputted triangle -> TO DO: optimise
-std::vector<std::pair<Triangle, Edge>> Delaunay::get_neighbors(Triangle current) {
-    std::vector<std::pair<Triangle, Edge>> neighbors;
-    for(const auto& triangle: triangles) {
-        if(triangle != current) {
-            for(const auto& any_edge: triangle.get_edges()) {
-                for(const auto& edge: current.get_edges()) {
-                    if(any_edge == edge) {
-                        neighbors.emplace_back(triangle, edge);
+// Lawson insertion: the containing triangle (or the two triangles sharing the edge the node lies on) is split
+// and the edges opposite to the node are flipped while the node lies inside the circumcircle across them.
+// Triangles keep their slots, so only the split takes new ones.
+int Delaunay::insert_flip(int v, int first) {
+    Coord2D p{point(v)};
+    Cavity& cavity{insertion};
+    cavity.created.clear();
+    auto record = [&](int t) {
+        if(record_removed && is_final(t)) {
+            removed_triangles.push_back(triangles[t]);
+        }
+    };
+    auto region = [&](int t) -> char {
+        return exterior.empty() ? 0 : exterior[t];
+    };
+
+    int edge{-1};
+    for(int k{0}; k < 3; k++) {
+        if(Predicates::orient2d(point(triangles[first][(k+1)%3]), point(triangles[first][(k+2)%3]), p) == 0) {
+            edge = k;
+        }
+    }
+    if(edge == -1) {
+        // Node inside the triangle: 1 to 3 split
+        std::array<int, 3> tv{triangles[first]}, tn{neighbors[first]};
+        char flag{region(first)};
+        record(first);
+        int t1{new_slot()}, t2{new_slot()};
+        set_triangle(first, {v, tv[1], tv[2]}, {tn[0], t1, t2});
+        set_triangle(t1, {tv[0], v, tv[2]}, {first, tn[1], t2});
+        set_triangle(t2, {tv[0], tv[1], v}, {first, t1, tn[2]});
+        replace_neighbor(tn[1], first, t1);
+        replace_neighbor(tn[2], first, t2);
+        if(!exterior.empty()) {
+            exterior[t1] = flag;
+            exterior[t2] = flag;
+        }
+        cavity.created.insert(cavity.created.end(), {first, t1, t2});
+        TRIMESH_STATS(stats.triangles_created += 3; stats.triangles_destroyed += 1;)
+    } else {
+        // Node on an edge: both triangles sharing it are split in two
+        int u{neighbors[first][edge]};
+        if(u == -1) {
+            return -1;
+        }
+        int j{0};
+        while(neighbors[u][j] != first) {
+            j++;
+        }
+        int a{triangles[first][edge]}, b{triangles[first][(edge+1)%3]}, c{triangles[first][(edge+2)%3]};
+        int d{triangles[u][j]};
+        int outer_ab{neighbors[first][(edge+2)%3]}, outer_ac{neighbors[first][(edge+1)%3]};
+        int outer_db{neighbors[u][vertex_position(u, c)]}, outer_dc{neighbors[u][vertex_position(u, b)]};
+        char flag_first{region(first)}, flag_u{region(u)};
+        record(first);
+        record(u);
+        int t1{new_slot()}, u1{new_slot()};
+        set_triangle(first, {a, b, v}, {u, t1, outer_ab});
+        set_triangle(t1, {a, c, v}, {u1, first, outer_ac});
+        set_triangle(u, {d, b, v}, {first, u1, outer_db});
+        set_triangle(u1, {d, c, v}, {t1, u, outer_dc});
+        replace_neighbor(outer_ac, first, t1);
+        replace_neighbor(outer_dc, u, u1);
+        if(!exterior.empty()) {
+            exterior[t1] = flag_first;
+            exterior[u1] = flag_u;
+        }
+        cavity.created.insert(cavity.created.end(), {first, t1, u, u1});
+        TRIMESH_STATS(stats.triangles_created += 4; stats.triangles_destroyed += 2;)
+    }
+
+    // Flip the edges opposite to the node that are not locally Delaunay
+    std::vector<int>& stack{cavity.removed};
+    stack.assign(cavity.created.begin(), cavity.created.end());
+    while(!stack.empty()) {
+        int t{stack.back()};
+        stack.pop_back();
+        int k{vertex_position(t, v)};
+        int u{neighbors[t][k]};
+        if(u < 0 || is_constrained(t, k) || region(t) != region(u) || !circumscribe(u, p)) {
+            continue;
+        }
+        int j{0};
+        while(neighbors[u][j] != t) {
+            j++;
+        }
+        Coord2D d{point(triangles[u][j])};
+        if(Predicates::orient2d(p, d, point(triangles[t][(k+1)%3])) * Predicates::orient2d(p, d, point(triangles[t][(k+2)%3])) >= 0) {
+            continue;
+        }
+        record(u);
+        flip(t, k);
+        cavity.created.push_back(u);
+        stack.push_back(t);
+        stack.push_back(u);
+    }
+    invalidate_final();
+    TRIMESH_STATS(
+        // Split triangles and one more for every flip
+        long long replaced{static_cast<long long>(cavity.created.size()) - 2};
+        stats.insertions++;
+        stats.cavity_triangles += replaced;
+        stats.max_cavity = std::max(stats.max_cavity, replaced);
+    )
+    last_triangle = cavity.created.front();
+    return cavity.created.front();
+}
+
+// Set the vertices (stored sorted) and neighbors (following their opposite vertex) of a triangle
+void Delaunay::set_triangle(int t, std::array<int, 3> v, std::array<int, 3> n) {
+    std::array<int, 3> order{0, 1, 2};
+    std::sort(order.begin(), order.end(), [&](int x, int y) { return v[x] < v[y]; });
+    triangles[t] = {v[order[0]], v[order[1]], v[order[2]]};
+    neighbors[t] = {n[order[0]], n[order[1]], n[order[2]]};
+    update_circle(t);
+}
+
+// Point the neighbor link of triangle t from one triangle to another (no-op for missing triangles)
+void Delaunay::replace_neighbor(int t, int from, int to) {
+    if(t < 0) {
+        return;
+    }
+    for(int& m: neighbors[t]) {
+        if(m == from) {
+            m = to;
+            return;
+        }
+    }
+}
+
+// Cavity boundary: edges whose neighbor across is not removed (outer triangle or none). Removed
+// triangles are the marked ones (see find_cavity) or, without marks, searched in the cavity list.
+void Delaunay::find_boundary(Cavity& cavity, bool marked) const {
+    cavity.boundary.clear();
+    cavity.regions.clear();
+    bool constrained{!exterior.empty()};
+    auto removed = [&](int t) {
+        if(marked) {
+            return marks[t] == stamp;
+        }
+        return std::find(cavity.removed.begin(), cavity.removed.end(), t) != cavity.removed.end();
+    };
+    for(int t: cavity.removed) {
+        for(int k{0}; k < 3; k++) {
+            int neighbor{neighbors[t][k]};
+            if(neighbor == -1 || !removed(neighbor)) {
+                cavity.boundary.push_back({triangles[t][(k+1)%3], triangles[t][(k+2)%3], neighbor});
+                cavity.regions.push_back(constrained ? exterior[t] : 0);
+            }
+        }
+    }
+}
+
+// Create the triangles joining node v with the cavity boundary, re-using the slots of the removed
+// triangles first and then the given ones. Only the cavity and the triangles across its boundary
+// are modified, so cavities that do not share them can be filled concurrently.
+void Delaunay::fill_cavity(int v, Cavity& cavity) {
+    const std::vector<std::array<int, 3>>& boundary{cavity.boundary};
+    bool constrained{!exterior.empty()};
+    std::vector<int>& created{cavity.created};
+    created.clear();
+    for(size_t i{0}; i < boundary.size(); i++) {
+        std::array<int, 3> vertices{v, boundary[i][0], boundary[i][1]};
+        std::sort(vertices.begin(), vertices.end());
+        int t{(i < cavity.removed.size()) ? cavity.removed[i] : cavity.slots[i - cavity.removed.size()]};
+        triangles[t] = vertices;
+        if(constrained) {
+            exterior[t] = cavity.regions[i];
+        }
+        neighbors[t] = {-1, -1, -1};
+        update_circle(t);
+        created.push_back(t);
+
+        // Link with the outer triangle across the cavity boundary
+        int outer{boundary[i][2]};
+        neighbors[t][vertex_position(t, v)] = outer;
+        if(outer != -1) {
+            for(int k{0}; k < 3; k++) {
+                int index{triangles[outer][k]};
+                if(index != boundary[i][0] && index != boundary[i][1]) {
+                    neighbors[outer][k] = t;
+                }
+            }
+        }
+    }
+
+    // Link new triangles among them: each boundary vertex is shared by two of them
+    std::vector<std::pair<int, int>>& pending{cavity.pending};
+    pending.clear();
+    for(size_t i{0}; i < boundary.size(); i++) {
+        int t{created[i]};
+        for(int j{0}; j < 2; j++) {
+            int shared{boundary[i][j]};
+            int opposite{boundary[i][1-j]};
+            auto match = std::find_if(pending.begin(), pending.end(), 
+                [shared](const std::pair<int, int>& p) { return p.first == shared; });
+            if(match == pending.end()) {
+                pending.emplace_back(shared, t);
+            } else {
+                int other{match->second};
+                neighbors[t][vertex_position(t, opposite)] = other;
+                for(int k{0}; k < 3; k++) {
+                    int index{triangles[other][k]};
+                    if(index != shared && index != v) {
+                        neighbors[other][k] = t;
                     }
                 }
+                pending.erase(match);
             }
         }
     }
-    return neighbors;
 }
 
-// Get bad triangles: triangle quality lower than input value
-std::vector<Triangle> Delaunay::get_bad_triangles(double alpha) {
-    // Instantiate bad triangles vector
-    std::vector<Triangle> bad_triangles;
+// Insert a batch of points in the current triangulation (in spatial order for short walks). Nodes are
+// appended in input order; if the triangulation was not computed yet it is computed with all nodes.
+Insertion Delaunay::add_points(const std::vector<Coord2D>& points) {
+    Insertion result{};
+    int first_node{get_nodes_count()};
+    if(triangles.empty()) {
+        for(const Coord2D& p: points) {
+            xs.push_back(p.x);
+            ys.push_back(p.y);
+        }
+        compute();
+        result.nodes.resize(points.size());
+        std::iota(result.nodes.begin(), result.nodes.end(), first_node);
+        View<std::array<int, 3>> created{get_triangles_view()};
+        result.created.assign(created.begin(), created.end());
+        return result;
+    }
 
-    // Loop over all triangles
-    for(auto& triangle: get_triangles()) {
-        if(triangle.get_alpha() < alpha) { // check quality
-            bad_triangles.push_back(triangle);
+    TRIMESH_STATS(PredicateScope predicates{stats};)
+
+    // Check the whole batch before modifying the triangulation
+    for(const Coord2D& p: points) {
+        for(int k{0}; k < 3; k++) {
+            int a{(k+1)%3 - 3}, b{(k+2)%3 - 3};
+            if(side(point(a), point(b), point(k - 3), p) < 0) {
+                throw std::out_of_range("Node lies outside the super triangle");
+            }
         }
     }
+    for(const Coord2D& p: points) {
+        xs.push_back(p.x);
+        ys.push_back(p.y);
+    }
 
-    return bad_triangles;
+    // Final triangles created and removed by every insertion
+    std::vector<std::array<int, 3>> created{};
+    removed_triangles.clear();
+    record_removed = true;
+    result.nodes.assign(points.size(), -1);
+    for(int i: spatial_order(points)) {
+        int v{first_node + i};
+        if(insert(v) == -1) {
+            continue;
+        }
+        result.nodes[i] = v;
+        for(int t: insertion.created) {
+            if(is_final(t)) {
+                created.push_back(triangles[t]);
+            }
+        }
+    }
+    record_removed = false;
+
+    // Triangles created and removed within the batch cancel out
+    std::sort(created.begin(), created.end());
+    std::sort(removed_triangles.begin(), removed_triangles.end());
+    std::set_difference(created.begin(), created.end(), removed_triangles.begin(), removed_triangles.end(),
+                        std::back_inserter(result.created));
+    std::set_difference(removed_triangles.begin(), removed_triangles.end(), created.begin(), created.end(),
+                        std::back_inserter(result.destroyed));
+    removed_triangles.clear();
+    return result;
 }
 
-// Get big triangles - area lower than right isosceles triangle with input leg length
-std::vector<Triangle> Delaunay::get_big_triangles(double h) {
-    // Instantiate big triangles
-    std::vector<Triangle> big_triangles;
+// Position (0, 1 or 2) of node v inside the triangle at position t (-1 if not a vertex)
+int Delaunay::vertex_position(int t, int v) const {
+    for(int k{0}; k < 3; k++) {
+        if(triangles[t][k] == v) {
+            return k;
+        }
+    }
+    return -1;
+}
+
+// Build triangle adjacency from scratch matching shared edges
+void Delaunay::build_neighbors() {
+    neighbors.assign(triangles.size(), {-1, -1, -1});
+    std::unordered_map<long long, std::pair<int, int>> edges{}; // edge -> {triangle, opposite vertex}
+    edges.reserve(3*triangles.size());
+    for(size_t t{0}; t < triangles.size(); t++) {
+        const std::array<int, 3>& v{triangles[t]};
+        for(int k{0}; k < 3; k++) {
+            long long key{edge_key(v[(k+1)%3], v[(k+2)%3])};
+            auto match = edges.find(key);
+            if(match == edges.end()) {
+                edges.emplace(key, std::make_pair(static_cast<int>(t), k));
+            } else {
+                neighbors[t][k] = match->second.first;
+                neighbors[match->second.first][match->second.second] = t;
+                edges.erase(match);
+            }
+        }
+    }
+}
 
-    // Loop over all triangles
-    for(auto& triangle: get_triangles()) {
-        if(triangle.get_area() > 0.5*h*h) { // check area
-            big_triangles.push_back(triangle);
+// Compaction (end of compute and refine): removed slots are dropped and the remaining triangles
+// are sorted keeping adjacency consistent
+void Delaunay::compact() {
+    invalidate_final();
+    std::vector<int> order{};
+    order.reserve(triangles.size() - free_slots.size());
+    for(size_t t{0}; t < triangles.size(); t++) {
+        if(!is_removed(t)) {
+            order.push_back(t);
         }
     }
+    std::sort(order.begin(), order.end(), [this](int a, int b) { return triangles[a] < triangles[b]; });
 
-    return big_triangles;
+    // Map old triangle positions to new ones
+    std::vector<int> position(triangles.size(), -1);
+    for(size_t i{0}; i < order.size(); i++) {
+        position[order[i]] = i;
+    }
+
+    // New arrays are allocated with the exact size so that no spare capacity is kept
+    std::vector<std::array<int, 3>> sorted_triangles{};
+    std::vector<std::array<int, 3>> sorted_neighbors{};
+    std::vector<Circumcircle> sorted_circles{};
+    std::vector<char> sorted_exterior{};
+    sorted_triangles.reserve(order.size());
+    sorted_neighbors.reserve(order.size());
+    sorted_circles.reserve(order.size());
+    if(!exterior.empty()) {
+        sorted_exterior.reserve(order.size());
+    }
+    for(int t: order) {
+        sorted_triangles.push_back(triangles[t]);
+        sorted_circles.push_back(circles[t]);
+        if(!exterior.empty()) {
+            sorted_exterior.push_back(exterior[t]);
+        }
+        std::array<int, 3> adjacent{neighbors[t]};
+        for(int& neighbor: adjacent) {
+            neighbor = (neighbor == -1) ? -1 : position[neighbor];
+        }
+        sorted_neighbors.push_back(adjacent);
+    }
+    triangles.swap(sorted_triangles);
+    neighbors.swap(sorted_neighbors);
+    circles.swap(sorted_circles);
+    exterior.swap(sorted_exterior);
+    free_slots.clear();
+    std::vector<int>{}.swap(marks);
+    last_triangle = (last_triangle >= 0 && last_triangle < static_cast<int>(position.size())) ? std::max(position[last_triangle], 0) : 0;
 }
 
-// Refine triangulation function
-std::vector<Triangle> Delaunay::refine(double alpha, double h) {
-    // Initialize bad triangles (bad quality)
-    std::vector<Triangle> bad_triangles = get_bad_triangles(alpha);
-    do {
-        for(auto triangle: bad_triangles) {
-            // check if there is no error -> TO DO: check why there is an error in some cases
-            try {
-                // add new point at the circumcenter of the worst triangle
-                add_point(triangle.circumcenter()); 
-
-                // adding a point needs triangulation recalculation -> TO DO: optimize algorithm to check only if new triangles are bad
-                break; 
-            } catch (const std::out_of_range& e) {
-                // if error worst triangle is skipped an for loop moves to the next worse triangle
-                std::cerr << "Inserting a new point has caused an out_of_range exception: " << e.what() << std::endl;
-            }
-        }
-        // re-compute bad triangles
-        bad_triangles = get_bad_triangles(alpha);
-    } while(bad_triangles.size() > 0); // refine bad triangles as long as there are bad triangles
-
-    // refine big triangles -> "new bad triangles"
-    std::vector<Triangle> big_triangles = get_big_triangles(h);
-    // refinement structure is repeated
-    do {
-        for(auto triangle: big_triangles) {
-            try {
-                add_point(triangle.circumcenter());
-                break;
-            } catch (const std::out_of_range& e) {
-                std::cerr << "Inserting a new point has caused an out_of_range exception: " << e.what() << std::endl;
+// Position of a triangle in the triangles list (-1 if not found)
+int Delaunay::find_triangle(const Triangle& t) const {
+    auto match = std::find(triangles.begin(), triangles.end(), t.get_vertices_index());
+    return (match == triangles.end()) ? -1 : static_cast<int>(match - triangles.begin());
+}
+
+// Node at the given point (within eps), inserted if the triangulation does not contain it (-1 if it cannot be)
+int Delaunay::find_vertex(const Coord2D& p) {
+    int t{locate(p)};
+    if(t != -1) {
+        // The node is a vertex of the containing triangle or of one of its neighbors
+        std::array<int, 4> candidates{t, neighbors[t][0], neighbors[t][1], neighbors[t][2]};
+        for(int candidate: candidates) {
+            if(candidate == -1) {
+                continue;
+            }
+            for(int v: triangles[candidate]) {
+                if(v >= 0 && point(v) == p) {
+                    return v;
+                }
             }
         }
-        big_triangles = get_big_triangles(h);
-    } while(big_triangles.size() > 0);
+    }
+    int v{get_nodes_count()};
+    xs.push_back(p.x);
+    ys.push_back(p.y);
+    if(insert(v) == -1) {
+        xs.pop_back();
+        ys.pop_back();
+        return -1;
+    }
+    return v;
+}
 
-    // return refined triangles
-    return get_triangles();
-}
\ No newline at end of file
+// Force the edge a-b into the triangulation: the triangles crossed by the segment are removed and
+// the polygons on both sides are re-triangulated (Anglada, 1997)
+void Delaunay::recover_segment(int a, int b) {
+    invalidate_final();
+    Coord2D pa{point(a)}, pb{point(b)};
+
+    // Triangle around a entered by the segment
+    int t{locate(pa)};
+    if(t == -1 || vertex_position(t, a) == -1) {
+        return;
+    }
+    int start{t}, previous{-1}, crossing{-1};
+    do {
+        int k{vertex_position(t, a)};
+        int u{triangles[t][(k+1)%3]}, w{triangles[t][(k+2)%3]};
+        if(u == b || w == b) {
+            constraints.insert(edge_key(a, b));
+            return;
+        }
+        // Nodes lying on the segment split it
+        for(int c: {u, w}) {
+            Coord2D pc{point(c)};
+            if(Predicates::orient2d(pa, pb, pc) == 0 && (pc.x - pa.x)*(pb.x - pa.x) + (pc.y - pa.y)*(pb.y - pa.y) > 0) {
+                recover_segment(a, c);
+                recover_segment(c, b);
+                return;
+            }
+        }
+        double ou{Predicates::orient2d(pa, pb, point(u))}, ow{Predicates::orient2d(pa, pb, point(w))};
+        if((ou > 0) != (ow > 0)) {
+            double oa{Predicates::orient2d(point(u), point(w), pa)}, ob{Predicates::orient2d(point(u), point(w), pb)};
+            if((oa > 0 && ob < 0) || (oa < 0 && ob > 0)) {
+                crossing = t;
+                break;
+            }
+        }
+        // Rotate around a
+        int next{neighbors[t][(k+1)%3]};
+        if(next == previous) {
+            next = neighbors[t][(k+2)%3];
+        }
+        previous = t;
+        t = next;
+    } while(t != -1 && t != start);
+    if(crossing == -1) {
+        return;
+    }
+
+    // Walk along the segment collecting the crossed triangles and the nodes on each side
+    std::vector<int> cavity{crossing};
+    std::vector<int> left{}, right{};
+    int k{vertex_position(crossing, a)};
+    int u{triangles[crossing][(k+1)%3]}, w{triangles[crossing][(k+2)%3]};
+    if(Predicates::orient2d(pa, pb, point(u)) < 0) {
+        std::swap(u, w);
+    }
+    left.push_back(u);
+    right.push_back(w);
+    t = crossing;
+    while(true) {
+        if(constraints.count(edge_key(u, w))) {
+            throw std::invalid_argument("Constraint segments intersect");
+        }
+        int next{-1};
+        for(int j{0}; j < 3; j++) {
+            if(triangles[t][j] != u && triangles[t][j] != w) {
+                next = neighbors[t][j];
+            }
+        }
+        int z{-1};
+        for(int vertex: triangles[next]) {
+            if(vertex != u && vertex != w) {
+                z = vertex;
+            }
+        }
+        cavity.push_back(next);
+        if(z == b) {
+            break;
+        }
+        double oz{Predicates::orient2d(pa, pb, point(z))};
+        if(oz == 0) {
+            // Node lying on the segment (nothing was modified yet)
+            recover_segment(a, z);
+            recover_segment(z, b);
+            return;
+        }
+        if(oz > 0) {
+            left.push_back(z);
+            u = z;
+        } else {
+            right.push_back(z);
+            w = z;
+        }
+        t = next;
+    }
+
+    // Edges bounding the removed triangles and the triangle across them
+    marks.resize(triangles.size(), 0);
+    stamp++;
+    for(int removed: cavity) {
+        marks[removed] = stamp;
+    }
+    std::unordered_map<long long, int> outer{};
+    for(int removed: cavity) {
+        for(int j{0}; j < 3; j++) {
+            int neighbor{neighbors[removed][j]};
+            if(neighbor == -1 || marks[neighbor] != stamp) {
+                outer.emplace(edge_key(triangles[removed][(j+1)%3], triangles[removed][(j+2)%3]), neighbor);
+            }
+        }
+    }
+
+    // Re-triangulate both sides re-using the slots of the removed triangles
+    std::vector<std::array<int, 3>> created{};
+    triangulate_polygon(a, b, left, created);
+    triangulate_polygon(a, b, right, created);
+    std::unordered_map<long long, std::pair<int, int>> inner{}; // edge -> {triangle, opposite vertex}
+    std::vector<int> slots{};
+    for(size_t i{0}; i < created.size(); i++) {
+        int slot{(i < cavity.size()) ? cavity[i] : new_slot()};
+        triangles[slot] = created[i];
+        neighbors[slot] = {-1, -1, -1};
+        update_circle(slot);
+        slots.push_back(slot);
+    }
+    for(size_t i{created.size()}; i < cavity.size(); i++) {
+        free_slot(cavity[i]);
+    }
+    for(size_t i{0}; i < created.size(); i++) {
+        int slot{slots[i]};
+        const std::array<int, 3>& v{triangles[slot]};
+        for(int j{0}; j < 3; j++) {
+            long long key{edge_key(v[(j+1)%3], v[(j+2)%3])};
+            auto boundary = outer.find(key);
+            if(boundary != outer.end()) {
+                int neighbor{boundary->second};
+                neighbors[slot][j] = neighbor;
+                if(neighbor != -1) {
+                    for(int m{0}; m < 3; m++) {
+                        if(triangles[neighbor][m] != v[(j+1)%3] && triangles[neighbor][m] != v[(j+2)%3]) {
+                            neighbors[neighbor][m] = slot;
+                        }
+                    }
+                }
+                continue;
+            }
+            auto match = inner.find(key);
+            if(match == inner.end()) {
+                inner.emplace(key, std::make_pair(slot, j));
+            } else {
+                neighbors[slot][j] = match->second.first;
+                neighbors[match->second.first][match->second.second] = slot;
+                inner.erase(match);
+            }
+        }
+    }
+    constraints.insert(edge_key(a, b));
+    last_triangle = slots.front();
+}
+
+// Constrained Delaunay triangulation of the polygon a, chain..., b where the chain lies on one side of a-b:
+// the apex of a-b is the chain node whose circle with a and b contains no other chain node
+void Delaunay::triangulate_polygon(int a, int b, const std::vector<int>& chain, std::vector<std::array<int, 3>>& result) const {
+    if(chain.empty()) {
+        return;
+    }
+    size_t c{0};
+    for(size_t i{1}; i < chain.size(); i++) {
+        if(in_circumcircle(point(a), point(b), point(chain[c]), point(chain[i]))) {
+            c = i;
+        }
+    }
+    triangulate_polygon(a, chain[c], std::vector<int>(chain.begin(), chain.begin() + c), result);
+    triangulate_polygon(chain[c], b, std::vector<int>(chain.begin() + c + 1, chain.end()), result);
+    std::array<int, 3> vertices{a, b, chain[c]};
+    std::sort(vertices.begin(), vertices.end());
+    result.push_back(vertices);
+}
+
+// Flood fill from the super triangle: triangles separated from it by an even number of
+// constrained edges lie outside the domain (or inside one of its holes)
+void Delaunay::mark_exterior() {
+    invalidate_final();
+    std::vector<int> depth(triangles.size(), -1);
+    std::vector<int> current{};
+    for(size_t t{0}; t < triangles.size(); t++) {
+        if(triangles[t][0] < 0 && !is_removed(t)) {
+            depth[t] = 0;
+            current.push_back(t);
+        }
+    }
+    int level{0};
+    while(!current.empty()) {
+        // Flood fill the current level, triangles across constrained edges belong to the next one
+        std::vector<int> next{};
+        for(size_t i{0}; i < current.size(); i++) {
+            int t{current[i]};
+            for(int k{0}; k < 3; k++) {
+                int neighbor{neighbors[t][k]};
+                if(neighbor == -1 || depth[neighbor] != -1) {
+                    continue;
+                }
+                if(is_constrained(t, k)) {
+                    next.push_back(neighbor);
+                } else {
+                    depth[neighbor] = level;
+                    current.push_back(neighbor);
+                }
+            }
+        }
+        level++;
+        current.clear();
+        for(int t: next) {
+            if(depth[t] == -1) {
+                depth[t] = level;
+                current.push_back(t);
+            }
+        }
+    }
+    exterior.assign(triangles.size(), 0);
+    for(size_t t{0}; t < triangles.size(); t++) {
+        exterior[t] = (depth[t] % 2 == 0);
+    }
+}
+
+// Recover the input segments and classify the triangles (degenerate segments are skipped)
+void Delaunay::apply_constraints() {
+    for(const Edge& segment: segments) {
+        std::array<Node, 2> ends{segment.get_vertices()};
+        if(ends[0] == ends[1]) {
+            continue;
+        }
+        int a{find_vertex(ends[0].get_coords())};
+        int b{find_vertex(ends[1].get_coords())};
+        if(a != -1 && b != -1 && a != b) {
+            recover_segment(a, b);
+        }
+    }
+    mark_exterior();
+}
+
+// Split the constrained edge a-b at its midpoint: returns one of the created triangles (-1 if not inserted)
+int Delaunay::split_segment(int a, int b) {
+    Coord2D m{midpoint(point(a), point(b))};
+    int v{get_nodes_count()};
+    xs.push_back(m.x);
+    ys.push_back(m.y);
+    // Both triangles next to the edge contain the midpoint in their circumcircle
+    constraints.erase(edge_key(a, b));
+    int t{insert(v)};
+    if(t == -1) {
+        xs.pop_back();
+        ys.pop_back();
+        constraints.insert(edge_key(a, b));
+        return -1;
+    }
+    constraints.insert(edge_key(a, v));
+    constraints.insert(edge_key(v, b));
+    return t;
+}
+
+// Run algorithm (nodes are inserted in spatial order unless sorted is false)
+std::vector<Triangle> Delaunay::compute(bool sorted) {
+    TRIMESH_TIMER(stats.compute_ms);
+    TRIMESH_STATS(PredicateScope predicates{stats};)
+    return compute_serial(sorted);
+}
+
+// Serial construction (the phase is timed by the calling entry point)
+std::vector<Triangle> Delaunay::compute_serial(bool sorted) {
+    // Empty triangles for clean re-computation
+    triangles.clear();
+    neighbors.clear();
+    circles.clear();
+    constraints.clear();
+    exterior.clear();
+    free_slots.clear();
+    invalidate_final();
+    last_triangle = 0;
+
+    // Compute super triangle
+    super_triangle();
+    triangles.push_back({-3, -2, -1});
+    neighbors.push_back({-1, -1, -1});
+    update_circle(0);
+
+    // Loop over all nodes
+    int n{get_nodes_count()};
+    if(sorted) {
+        std::vector<Coord2D> points;
+        points.reserve(n);
+        for(int v{0}; v < n; v++) {
+            points.push_back(point(v));
+        }
+        for(int v: spatial_order(points)) {
+            insert(v);
+        }
+    } else {
+        for(int v{0}; v < n; v++) {
+            insert(v);
+        }
+    }
+
+    // Constrained mode
+    if(!segments.empty()) {
+        apply_constraints();
+    }
+
+    // Drop removed slots and ensure proper triangles ordering
+    compact();
+
+    std::vector<Triangle> triangle_list;
+    triangle_list.reserve(triangles.size());
+    for(size_t t{0}; t < triangles.size(); t++) {
+        triangle_list.push_back(triangle(t));
+    }
+    return triangle_list;
+}
+
+// Parallel construction: nodes are split in vertical strips which are triangulated concurrently.
+// Triangles whose circumcircle lies inside their strip are final. The rest of the domain is
+// triangulated from the nodes of the remaining triangles and bounded by the edges of the final ones.
+std::vector<Triangle> Delaunay::compute_parallel(int threads) {
+    if(threads <= 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    int n{get_nodes_count()};
+    if(threads == 1 || n < 256*threads) {
+        return compute();
+    }
+    TRIMESH_TIMER(stats.compute_ms);
+    TRIMESH_STATS(PredicateScope predicates{stats};)
+
+    // Sort nodes by x coordinate to build strips with the same number of nodes
+    std::vector<int> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [this](int a, int b) {
+        return xs[a+3] < xs[b+3] || (xs[a+3] == xs[b+3] && ys[a+3] < ys[b+3]);
+    });
+
+    super_triangle();
+
+    // Triangles of the strips which are already final, and nodes of the other ones (seam nodes)
+    std::vector<std::vector<std::array<int, 3>>> safe(threads);
+    std::vector<char> seam(n, 0);
+    TRIMESH_STATS(std::vector<Stats> strip_stats(threads);)
+
+    auto triangulate_strip = [&](int s) {
+        TRIMESH_STATS(PredicateScope predicates{strip_stats[s]};)
+        int begin{static_cast<int>(static_cast<long long>(n) * s / threads)};
+        int end{static_cast<int>(static_cast<long long>(n) * (s+1) / threads)};
+        double inf{std::numeric_limits<double>::infinity()};
+        double lo{(s == 0) ? -inf : point(order[begin]).x};
+        double hi{(s == threads-1) ? inf : point(order[end]).x};
+
+        std::vector<Coord2D> points;
+        points.reserve(end - begin);
+        for(int i{begin}; i < end; i++) {
+            points.push_back(point(order[i]));
+        }
+        Delaunay strip{points, engine};
+        strip.compute_serial(true);
+        TRIMESH_STATS(strip_stats[s] += strip.stats;)
+
+        for(size_t t{0}; t < strip.triangles.size(); t++) {
+            std::array<int, 3> v{strip.triangles[t]};
+            bool final_triangle{strip.is_final(t)};
+            if(final_triangle) {
+                // Circumcircle must not reach other strips (with a margin for rounding errors)
+                const Circumcircle& circle{strip.circles[t]};
+                double radius{std::sqrt(circle.r2)};
+                double margin{1e-6 * radius + 1e-12 * (std::abs(circle.x) + 1)};
+                final_triangle = circle.x - radius > lo + margin && circle.x + radius < hi - margin;
+                for(int super_node{-3}; super_node < 0 && final_triangle; super_node++) {
+                    final_triangle = !strip.circumscribe(t, point(super_node));
+                }
+            }
+            for(int& index: v) {
+                index = (index < 0) ? index : order[begin + index];
+            }
+            if(final_triangle) {
+                std::sort(v.begin(), v.end());
+                safe[s].push_back(v);
+            } else {
+                for(int index: v) {
+                    if(index >= 0) {
+                        seam[index] = 1;
+                    }
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for(int s{0}; s < threads; s++) {
+        workers.emplace_back(triangulate_strip, s);
+    }
+    for(std::thread& worker: workers) {
+        worker.join();
+    }
+
+    // Triangulate seam nodes inside the global super triangle
+    Delaunay seam_triangulation{};
+    seam_triangulation.xs = xs;
+    seam_triangulation.ys = ys;
+    seam_triangulation.triangles.push_back({-3, -2, -1});
+    seam_triangulation.neighbors.push_back({-1, -1, -1});
+    seam_triangulation.update_circle(0);
+    std::vector<Coord2D> seam_points;
+    std::vector<int> seam_nodes;
+    for(int v{0}; v < n; v++) {
+        if(seam[v]) {
+            seam_points.push_back(point(v));
+            seam_nodes.push_back(v);
+        }
+    }
+    for(int i: spatial_order(seam_points)) {
+        seam_triangulation.insert(seam_nodes[i]);
+    }
+    TRIMESH_STATS(
+        for(const Stats& strip: strip_stats) {
+            stats += strip;
+        }
+        stats += seam_triangulation.stats;
+    )
+    const std::vector<std::array<int, 3>>& seam_triangles{seam_triangulation.triangles};
+
+    // Edges bounding the final triangles and the vertex on their final side
+    std::unordered_map<long long, int> bounding_edges;
+    for(const auto& strip_safe: safe) {
+        for(const std::array<int, 3>& v: strip_safe) {
+            for(int k{0}; k < 3; k++) {
+                long long key{edge_key(v[(k+1)%3], v[(k+2)%3])};
+                auto match = bounding_edges.find(key);
+                if(match == bounding_edges.end()) {
+                    bounding_edges.emplace(key, v[k]);
+                } else {
+                    bounding_edges.erase(match);
+                }
+            }
+        }
+    }
+
+    // Seam triangles on the outer side of the bounding edges are seeds of the remaining domain
+    std::vector<int> remaining;
+    std::vector<char> visited(seam_triangles.size(), 0);
+    for(size_t t{0}; t < seam_triangles.size(); t++) {
+        if(seam_triangulation.is_removed(t)) {
+            continue;
+        }
+        const std::array<int, 3>& v{seam_triangles[t]};
+        bool seed{v[0] < 0};
+        for(int k{0}; k < 3 && !seed; k++) {
+            int a{v[(k+1)%3]}, b{v[(k+2)%3]};
+            auto match = bounding_edges.find(edge_key(a, b));
+            if(match != bounding_edges.end()) {
+                double inner{Predicates::orient2d(point(a), point(b), point(match->second))};
+                double own{Predicates::orient2d(point(a), point(b), point(v[k]))};
+                seed = (inner > 0) != (own > 0);
+            }
+        }
+        if(seed) {
+            visited[t] = 1;
+            remaining.push_back(t);
+        }
+    }
+
+    // Flood fill the remaining domain without crossing the bounding edges
+    for(size_t i{0}; i < remaining.size(); i++) {
+        int t{remaining[i]};
+        const std::array<int, 3>& v{seam_triangles[t]};
+        for(int k{0}; k < 3; k++) {
+            int neighbor{seam_triangulation.neighbors[t][k]};
+            if(neighbor == -1 || visited[neighbor] || bounding_edges.count(edge_key(v[(k+1)%3], v[(k+2)%3]))) {
+                continue;
+            }
+            visited[neighbor] = 1;
+            remaining.push_back(neighbor);
+        }
+    }
+
+    // Merge final strip triangles and remaining seam triangles
+    triangles.clear();
+    constraints.clear();
+    exterior.clear();
+    free_slots.clear();
+    invalidate_final();
+    for(const auto& strip_safe: safe) {
+        triangles.insert(triangles.end(), strip_safe.begin(), strip_safe.end());
+    }
+    for(int t: remaining) {
+        triangles.push_back(seam_triangles[t]);
+    }
+    build_neighbors();
+    update_circles();
+    last_triangle = 0;
+
+    // A triangulation of the nodes and the super triangle has 2n+1 triangles and only 3 outer edges,
+    // degenerate inputs (duplicated or cocircular nodes) may break it: use the serial algorithm then
+    int outer_edges{0};
+    for(const std::array<int, 3>& adjacent: neighbors) {
+        outer_edges += std::count(adjacent.begin(), adjacent.end(), -1);
+    }
+    if(static_cast<int>(triangles.size()) != 2*n + 1 || outer_edges != 3) {
+        TRIMESH_STATS(stats.parallel_fallbacks++;)
+        return compute_serial(true);
+    }
+
+    // Constrained mode
+    if(!segments.empty()) {
+        apply_constraints();
+    }
+
+    // Drop removed slots and ensure proper triangles ordering
+    compact();
+
+    std::vector<Triangle> triangle_list;
+    triangle_list.reserve(triangles.size());
+    for(size_t t{0}; t < triangles.size(); t++) {
+        triangle_list.push_back(triangle(t));
+    }
+    return triangle_list;
+}
+
+// Delaunay getters
+std::vector<Node> Delaunay::get_nodes() const {
+    std::vector<Node> nodes;
+    nodes.reserve(get_nodes_count());
+    for(int v{0}; v < get_nodes_count(); v++) {
+        nodes.emplace_back(point(v), v);
+    }
+    return nodes;
+}
+
+std::vector<Edge> Delaunay::get_edges() const {
+    std::vector<Edge> edges;
+    for(const std::array<int, 2>& e: get_edges_view()) {
+        edges.emplace_back(Node{point(e[0]), e[0]}, Node{point(e[1]), e[1]});
+    }
+    return edges;
+}
+
+std::vector<std::array<int, 2>> Delaunay::get_edges_index() const {
+    View<std::array<int, 2>> edges{get_edges_view()};
+    return std::vector<std::array<int, 2>>(edges.begin(), edges.end());
+}
+
+std::vector<Triangle> Delaunay::get_triangles() const {
+    update_final();
+    std::vector<Triangle> triangle_list;
+    triangle_list.reserve(final_positions.size());
+    for(int t: final_positions) {
+        triangle_list.push_back(triangle(t));
+    }
+    return triangle_list;
+}
+
+std::vector<std::array<int, 3>> Delaunay::get_triangles_index() const {
+    View<std::array<int, 3>> triangles_view{get_triangles_view()};
+    return std::vector<std::array<int, 3>>(triangles_view.begin(), triangles_view.end());
+}
+
+// Node coordinates (super triangle nodes are skipped)
+View<double> Delaunay::get_x() const {
+    return View<double>{xs.data() + 3, xs.size() - 3};
+}
+
+View<double> Delaunay::get_y() const {
+    return View<double>{ys.data() + 3, ys.size() - 3};
+}
+
+// Final triangles in the order of get_triangles()
+View<std::array<int, 3>> Delaunay::get_triangles_view() const {
+    update_final();
+    return View<std::array<int, 3>>{final_triangles.data(), final_triangles.size()};
+}
+
+// Unique edges of the final triangles sorted by node indices
+View<std::array<int, 2>> Delaunay::get_edges_view() const {
+    update_edges();
+    return View<std::array<int, 2>>{final_edges.data(), final_edges.size()};
+}
+
+// Function to get the neighboring triangles to the inputted triangle (super triangle ones are skipped)
+std::vector<std::pair<Triangle, Edge>> Delaunay::get_neighbors(Triangle current) const {
+    std::vector<std::pair<Triangle, Edge>> neighbors_list;
+    int t{find_triangle(current)};
+    if(t == -1) {
+        return neighbors_list;
+    }
+    const std::array<int, 3>& v{triangles[t]};
+    for(int k{0}; k < 3; k++) {
+        int neighbor{neighbors[t][k]};
+        if(neighbor == -1 || !is_final(neighbor)) {
+            continue;
+        }
+        int a{v[(k+1)%3]}, b{v[(k+2)%3]};
+        neighbors_list.emplace_back(triangle(neighbor), Edge{Node{point(a), a}, Node{point(b), b}});
+    }
+    std::sort(neighbors_list.begin(), neighbors_list.end(), 
+        [](const std::pair<Triangle, Edge>& a, const std::pair<Triangle, Edge>& b) { return a.first < b.first; });
+    return neighbors_list;
+}
+
+// Adjacency of get_triangles() list: entry k is the neighbor across the edge opposite to vertex k (-1 if none)
+std::vector<std::array<int, 3>> Delaunay::get_neighbors_index() const {
+    // Map internal triangle positions to positions in the filtered list
+    std::vector<int> position(triangles.size(), -1);
+    int n{0};
+    for(size_t t{0}; t < triangles.size(); t++) {
+        if(is_final(t)) {
+            position[t] = n++;
+        }
+    }
+
+    std::vector<std::array<int, 3>> neighbors_index{};
+    neighbors_index.reserve(n);
+    for(size_t t{0}; t < triangles.size(); t++) {
+        if(position[t] == -1) {
+            continue;
+        }
+        std::array<int, 3> adjacent{};
+        for(int k{0}; k < 3; k++) {
+            int neighbor{neighbors[t][k]};
+            adjacent[k] = (neighbor == -1) ? -1 : position[neighbor];
+        }
+        neighbors_index.push_back(adjacent);
+    }
+    return neighbors_index;
+}
+
+// Constrained edges (input segments, split by refinement)
+std::vector<std::array<int, 2>> Delaunay::get_constraints_index() const {
+    std::vector<std::array<int, 2>> constraints_index;
+    constraints_index.reserve(constraints.size());
+    for(long long key: constraints) {
+        constraints_index.push_back(edge_vertices(key));
+    }
+    std::sort(constraints_index.begin(), constraints_index.end());
+    return constraints_index;
+}
+
+// Triangulation made of the final triangles only: nodes not used by them are dropped and the
+// rest are renumbered keeping their order. Adjacency, circumcircles and constrained edges are kept.
+Delaunay Delaunay::extract_domain() const {
+    Delaunay domain{engine};
+    std::vector<int> node_position(get_nodes_count(), -1);
+    std::vector<int> position(triangles.size(), -1);
+    int n{0};
+    for(size_t t{0}; t < triangles.size(); t++) {
+        if(is_final(t)) {
+            position[t] = n++;
+            for(int v: triangles[t]) {
+                node_position[v] = 0;
+            }
+        }
+    }
+    for(int v{0}; v < get_nodes_count(); v++) {
+        if(node_position[v] != -1) {
+            node_position[v] = domain.get_nodes_count();
+            domain.xs.push_back(xs[v+3]);
+            domain.ys.push_back(ys[v+3]);
+        }
+    }
+
+    domain.triangles.reserve(n);
+    domain.neighbors.reserve(n);
+    domain.circles.reserve(n);
+    for(size_t t{0}; t < triangles.size(); t++) {
+        if(position[t] == -1) {
+            continue;
+        }
+        // Renumbering keeps the order of the nodes so vertices remain sorted
+        std::array<int, 3> v{};
+        std::array<int, 3> adjacent{};
+        for(int k{0}; k < 3; k++) {
+            v[k] = node_position[triangles[t][k]];
+            int neighbor{neighbors[t][k]};
+            adjacent[k] = (neighbor == -1) ? -1 : position[neighbor];
+        }
+        domain.triangles.push_back(v);
+        domain.neighbors.push_back(adjacent);
+        domain.circles.push_back(circles[t]);
+    }
+    for(long long key: constraints) {
+        std::array<int, 2> e{edge_vertices(key)};
+        if(node_position[e[0]] != -1 && node_position[e[1]] != -1) {
+            domain.constraints.insert(edge_key(node_position[e[0]], node_position[e[1]]));
+        }
+    }
+    return domain;
+}
+
+// Write the final triangles to a binary mesh file (see MeshFile.hpp): nodes keep their indices
+void Delaunay::save(const std::string& filename, bool adjacency) const {
+    std::ofstream file{filename, std::ios::binary};
+    if(!file) {
+        throw std::runtime_error("Cannot open " + filename);
+    }
+
+    // Positions of the final triangles in the saved list
+    std::vector<int> position(triangles.size(), -1);
+    int count{0};
+    for(size_t t{0}; t < triangles.size(); t++) {
+        if(is_final(t)) {
+            position[t] = count++;
+        }
+    }
+    bool contiguous{count == static_cast<int>(triangles.size())};
+    std::vector<std::array<int, 2>> segments_index{get_constraints_index()};
+
+    // Section layout
+    uint64_t n{static_cast<uint64_t>(get_nodes_count())};
+    auto align = [](uint64_t offset) {
+        return (offset + 7) / 8 * 8;
+    };
+    MeshFile::Header header{};
+    std::memcpy(header.magic, MeshFile::magic, sizeof(header.magic));
+    header.version = MeshFile::version;
+    header.flags = adjacency ? MeshFile::adjacency : 0;
+    header.byte_order = MeshFile::byte_order;
+    header.nodes = n;
+    header.triangles = count;
+    header.segments = segments_index.size();
+    header.x_offset = align(sizeof(MeshFile::Header));
+    header.y_offset = align(header.x_offset + n * sizeof(double));
+    header.triangles_offset = align(header.y_offset + n * sizeof(double));
+    uint64_t end{header.triangles_offset + count * sizeof(std::array<int, 3>)};
+    if(adjacency) {
+        header.neighbors_offset = align(end);
+        end = header.neighbors_offset + count * sizeof(std::array<int, 3>);
+    }
+    header.segments_offset = align(end);
+
+    uint64_t written{0};
+    auto write = [&](const void* data, uint64_t size) {
+        file.write(static_cast<const char*>(data), size);
+        written += size;
+    };
+    auto pad = [&](uint64_t offset) {
+        const char zeros[8]{};
+        write(zeros, offset - written);
+    };
+
+    write(&header, sizeof(header));
+    pad(header.x_offset);
+    write(xs.data() + 3, n * sizeof(double));
+    pad(header.y_offset);
+    write(ys.data() + 3, n * sizeof(double));
+
+    // Triangles (and adjacency) are written directly if all of them are final, in chunks otherwise
+    std::vector<std::array<int, 3>> buffer;
+    auto write_filtered = [&](const std::vector<std::array<int, 3>>& source, bool remap) {
+        if(contiguous) {
+            write(source.data(), source.size() * sizeof(std::array<int, 3>));
+            return;
+        }
+        const size_t chunk{4096};
+        buffer.clear();
+        buffer.reserve(chunk);
+        for(size_t t{0}; t < source.size(); t++) {
+            if(position[t] == -1) {
+                continue;
+            }
+            std::array<int, 3> entry{source[t]};
+            if(remap) {
+                for(int& neighbor: entry) {
+                    neighbor = (neighbor == -1) ? -1 : position[neighbor];
+                }
+            }
+            buffer.push_back(entry);
+            if(buffer.size() == chunk) {
+                write(buffer.data(), buffer.size() * sizeof(std::array<int, 3>));
+                buffer.clear();
+            }
+        }
+        write(buffer.data(), buffer.size() * sizeof(std::array<int, 3>));
+    };
+    pad(header.triangles_offset);
+    write_filtered(triangles, false);
+    if(adjacency) {
+        pad(header.neighbors_offset);
+        write_filtered(neighbors, true);
+    }
+    pad(header.segments_offset);
+    write(segments_index.data(), segments_index.size() * sizeof(std::array<int, 2>));
+
+    if(!file) {
+        throw std::runtime_error("Cannot write " + filename);
+    }
+}
+
+// Circumcircles of get_triangles() list
+std::vector<Coord2D> Delaunay::get_circumcenters() const {
+    update_final();
+    std::vector<Coord2D> centers;
+    centers.reserve(final_positions.size());
+    for(int t: final_positions) {
+        centers.emplace_back(circles[t].x, circles[t].y);
+    }
+    return centers;
+}
+
+std::vector<double> Delaunay::get_circumradii() const {
+    update_final();
+    std::vector<double> radii;
+    radii.reserve(final_positions.size());
+    for(int t: final_positions) {
+        radii.push_back(std::sqrt(circles[t].r2));
+    }
+    return radii;
+}
+
+// Area of the triangle at the given position
+double Delaunay::area(int t) const {
+    const std::array<int, 3>& v{triangles[t]};
+    return ::area(point(v[0]), point(v[1]), point(v[2]));
+}
+
+// Off-center of the triangle at the given position: on the bisector of the shortest edge, at the distance
+// where the triangle formed with that edge has its apex angle slightly above alpha (same constant as
+// Shewchuk's Triangle). The circumcenter is kept if it is closer to the edge.
+Coord2D Delaunay::offcenter(int t, double alpha) const {
+    const std::array<int, 3>& v{triangles[t]};
+    int shortest{0};
+    for(int k{1}; k < 3; k++) {
+        if(dist(point(v[(k+1)%3]), point(v[(k+2)%3])) < dist(point(v[(shortest+1)%3]), point(v[(shortest+2)%3]))) {
+            shortest = k;
+        }
+    }
+    Coord2D a{point(v[(shortest+1)%3])}, b{point(v[(shortest+2)%3])};
+    Coord2D center{circles[t].x, circles[t].y};
+    Coord2D middle{midpoint(a, b)};
+    // Normal of the edge (same length) pointing to the circumcenter
+    double nx{a.y - b.y}, ny{b.x - a.x};
+    if((center.x - middle.x)*nx + (center.y - middle.y)*ny < 0) {
+        nx = -nx;
+        ny = -ny;
+    }
+    double k{0.475 * std::sqrt((1 + std::cos(alpha)) / (1 - std::cos(alpha)))};
+    Coord2D off{middle.x + k*nx, middle.y + k*ny};
+    return (dist(off, middle) < dist(center, middle)) ? off : center;
+}
+
+// Size rule: area bigger than the right isosceles triangle with the leg length of the size field at the centroid
+bool Delaunay::is_big(int t, const SizeField& size) const {
+    const std::array<int, 3>& v{triangles[t]};
+    Coord2D a{point(v[0])}, b{point(v[1])}, c{point(v[2])};
+    double h{size(Coord2D{(a.x + b.x + c.x) / 3, (a.y + b.y + c.y) / 3})};
+    return area(t) > 0.5*h*h;
+}
+
+// Final triangles (see update_final) in blocks of coordinates for the batched kernels: body gets every
+// block and the index of its first triangle
+template<typename Body>
+static void for_each_block(const std::vector<std::array<int, 3>>& triangles, const std::vector<double>& xs,
+                           const std::vector<double>& ys, Body body) {
+    constexpr size_t size{256};
+    std::array<double, size> ax, ay, bx, by, cx, cy;
+    for(size_t first{0}; first < triangles.size(); first += size) {
+        size_t count{std::min(size, triangles.size() - first)};
+        for(size_t i{0}; i < count; i++) {
+            // Super triangle nodes are stored first (see point)
+            const std::array<int, 3>& v{triangles[first + i]};
+            ax[i] = xs[v[0] + 3];
+            ay[i] = ys[v[0] + 3];
+            bx[i] = xs[v[1] + 3];
+            by[i] = ys[v[1] + 3];
+            cx[i] = xs[v[2] + 3];
+            cy[i] = ys[v[2] + 3];
+        }
+        body(Kernels::TriangleBlock{ax.data(), ay.data(), bx.data(), by.data(), cx.data(), cy.data(), count}, first);
+    }
+}
+
+// Get bad triangles: triangle quality lower than input value (minimum angle cosine above the cosine of alpha)
+std::vector<Triangle> Delaunay::get_bad_triangles(double alpha) const {
+    // Instantiate bad triangles vector
+    std::vector<Triangle> bad_triangles;
+
+    // Loop over final triangles
+    update_final();
+    double bound{std::cos(alpha)};
+    std::array<double, 256> cosines;
+    for_each_block(final_triangles, xs, ys, [&](const Kernels::TriangleBlock& block, size_t first) {
+        Kernels::min_angle_cosines(block, cosines.data());
+        for(size_t i{0}; i < block.count; i++) {
+            if(cosines[i] > bound) { // check quality
+                bad_triangles.push_back(triangle(final_positions[first + i]));
+            }
+        }
+    });
+
+    return bad_triangles;
+}
+
+// Get big triangles - area lower than right isosceles triangle with input leg length
+std::vector<Triangle> Delaunay::get_big_triangles(double h) const {
+    // Instantiate big triangles
+    std::vector<Triangle> big_triangles;
+
+    // Loop over final triangles
+    update_final();
+    std::array<double, 256> areas;
+    for_each_block(final_triangles, xs, ys, [&](const Kernels::TriangleBlock& block, size_t first) {
+        Kernels::signed_areas(block, areas.data());
+        for(size_t i{0}; i < block.count; i++) {
+            if(std::abs(areas[i]) > 0.5*h*h) { // check area
+                big_triangles.push_back(triangle(final_positions[first + i]));
+            }
+        }
+    });
+
+    return big_triangles;
+}
+
+// Same with the leg length given by a size field at the centroid
+std::vector<Triangle> Delaunay::get_big_triangles(const SizeField& size) const {
+    // Instantiate big triangles
+    std::vector<Triangle> big_triangles;
+
+    // Loop over final triangles
+    update_final();
+    std::array<double, 256> areas;
+    for_each_block(final_triangles, xs, ys, [&](const Kernels::TriangleBlock& block, size_t first) {
+        Kernels::signed_areas(block, areas.data());
+        for(size_t i{0}; i < block.count; i++) {
+            double h{size(Coord2D{(block.ax[i] + block.bx[i] + block.cx[i]) / 3, (block.ay[i] + block.by[i] + block.cy[i]) / 3})};
+            if(std::abs(areas[i]) > 0.5*h*h) { // check area
+                big_triangles.push_back(triangle(final_positions[first + i]));
+            }
+        }
+    });
+
+    return big_triangles;
+}
+
+// Add a node at the given point if it can be inserted in the triangulation
+bool Delaunay::add_steiner_point(Coord2D p) {
+    int v{get_nodes_count()};
+    xs.push_back(p.x);
+    ys.push_back(p.y);
+    if(insert(v) == -1) {
+        xs.pop_back();
+        ys.pop_back();
+        return false;
+    }
+    return true;
+}
+
+// Run body(i) for i in [0, count) interleaved over the given number of threads, predicate counts of the
+// workers are added to stats
+static void parallel_for(int threads, size_t count, const std::function<void(size_t)>& body, Stats& stats) {
+    size_t workers_count{std::min(static_cast<size_t>(threads), count)};
+    if(workers_count <= 1) {
+        for(size_t i{0}; i < count; i++) {
+            body(i);
+        }
+        return;
+    }
+    std::vector<std::thread> workers;
+    std::vector<Stats> counted(workers_count);
+    for(size_t w{0}; w < workers_count; w++) {
+        workers.emplace_back([&, w]() {
+            TRIMESH_STATS(PredicateScope predicates{counted[w]};)
+            for(size_t i{w}; i < count; i += workers_count) {
+                body(i);
+            }
+        });
+    }
+    for(std::thread& worker: workers) {
+        worker.join();
+    }
+    for(const Stats& worker: counted) {
+        stats += worker;
+    }
+}
+
+// Threads kept for a sequence of parallel loops (e.g. every color of every smoothing iteration): run(count,
+// body) runs body(i) for i in [0, count) interleaved over the workers and the calling thread, and returns
+// once all of them are done. Without extra threads the loop runs serially. Predicate counts of the workers
+// are added to stats when the pool is destroyed.
+class WorkerPool {
+    std::vector<std::thread> workers{};
+    std::vector<Stats> counted{};
+    Stats& stats;
+    size_t stride;
+    std::mutex mutex{};
+    std::condition_variable start{};
+    std::condition_variable done{};
+    const std::function<void(size_t)>* body{nullptr};
+    size_t count{0};
+    int generation{0};
+    int pending{0};
+    bool stop{false};
+    void work(size_t w) {
+        TRIMESH_STATS(PredicateScope predicates{counted[w - 1]};)
+        int seen{0};
+        while(true) {
+            std::unique_lock<std::mutex> lock{mutex};
+            start.wait(lock, [&]() { return stop || generation != seen; });
+            if(stop) {
+                return;
+            }
+            seen = generation;
+            const std::function<void(size_t)>& job{*body};
+            size_t n{count};
+            lock.unlock();
+            for(size_t i{w}; i < n; i += stride) {
+                job(i);
+            }
+            lock.lock();
+            if(--pending == 0) {
+                done.notify_one();
+            }
+        }
+    }
+public:
+    WorkerPool(int threads, Stats& stats) : stats{stats}, stride{static_cast<size_t>(std::max(1, threads))} {
+        counted.resize(stride - 1);
+        for(int w{1}; w < threads; w++) {
+            workers.emplace_back(&WorkerPool::work, this, w);
+        }
+    }
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            stop = true;
+        }
+        start.notify_all();
+        for(std::thread& worker: workers) {
+            worker.join();
+        }
+        for(const Stats& worker: counted) {
+            stats += worker;
+        }
+    }
+    void run(size_t n, const std::function<void(size_t)>& job) {
+        if(workers.empty() || n <= 1) {
+            for(size_t i{0}; i < n; i++) {
+                job(i);
+            }
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            body = &job;
+            count = n;
+            pending = workers.size();
+            generation++;
+        }
+        start.notify_all();
+        for(size_t i{0}; i < n; i += stride) {
+            job(i);
+        }
+        std::unique_lock<std::mutex> lock{mutex};
+        done.wait(lock, [&]() { return pending == 0; });
+    }
+};
+
+// Refinement work item: triangle position and vertices (to detect stale entries once the slot is reused)
+struct RefineItem {
+    double priority;
+    double tie;
+    int t;
+    std::array<int, 3> vertices;
+    bool operator<(const RefineItem& other) const {
+        // std::priority_queue pops the largest item: lower priority values go first
+        return priority > other.priority || (priority == other.priority && tie > other.tie);
+    }
+};
+
+// Refine triangulation function: triangles are processed from a priority queue and only
+// the triangles created by each Steiner point are evaluated again. In constrained mode Steiner
+// points are never inserted outside the domain: segments encroached by a node or by a circumcenter
+// are split at their midpoint instead (Ruppert, 1995). With several threads (0 uses all cores)
+// Steiner points are inserted in rounds of non-overlapping cavities. The element size is given by a
+// size field evaluated at the triangle centroids. Off-centers replace circumcenters of bad triangles
+// when they are closer to the shortest edge (big triangles always use circumcenters).
+std::vector<Triangle> Delaunay::refine(double alpha, const SizeField& size, int threads, Placement placement) {
+    if(threads <= 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    TRIMESH_STATS(PredicateScope predicates{stats};)
+    std::priority_queue<RefineItem> queue;
+    std::vector<std::array<int, 2>> encroached;
+
+    // Segments are not split below half of the shortest one (guards small input angles)
+    double min_length{std::numeric_limits<double>::infinity()};
+    for(long long key: constraints) {
+        std::array<int, 2> e{edge_vertices(key)};
+        min_length = std::min(min_length, 0.5 * dist(point(e[0]), point(e[1])));
+    }
+    auto splittable = [&](int a, int b) {
+        return dist(point(a), point(b)) >= min_length;
+    };
+
+    // Constrained edges of a triangle encroached by its opposite vertex
+    auto check_encroached = [&](int t) {
+        if(constraints.empty() || !is_final(t)) {
+            return;
+        }
+        const std::array<int, 3>& v{triangles[t]};
+        for(int k{0}; k < 3; k++) {
+            int a{v[(k+1)%3]}, b{v[(k+2)%3]};
+            if(is_constrained(t, k) && encroaches(point(a), point(b), point(v[k])) && splittable(a, b)) {
+                encroached.push_back({a, b});
+            }
+        }
+    };
+
+    // Quality rule: worst angle (largest minimum angle cosine) first, then biggest area
+    double bound{std::cos(alpha)};
+    auto queue_bad = [&](int t, double cosine) {
+        if(cosine > bound) {
+            queue.push(RefineItem{-cosine, -area(t), t, triangles[t]});
+        }
+    };
+    auto push_bad = [&](int t) {
+        if(!is_final(t)) {
+            return;
+        }
+        const std::array<int, 3>& v{triangles[t]};
+        queue_bad(t, Kernels::min_angle_cosine(point(v[0]), point(v[1]), point(v[2])));
+    };
+
+    // Size rule: biggest area first (area lower than right isosceles triangle with leg length h)
+    auto push_big = [&](int t) {
+        if(!is_final(t) || !is_big(t, size)) {
+            return;
+        }
+        queue.push(RefineItem{-area(t), 0, t, triangles[t]});
+    };
+
+    // Steiner point of a queued triangle
+    bool quality_phase{true};
+    auto steiner_point = [&](int t) {
+        if(quality_phase && placement == Placement::offcenter) {
+            return offcenter(t, alpha);
+        }
+        return Coord2D{circles[t].x, circles[t].y};
+    };
+
+    // Split encroached segments (they go before any circumcenter)
+    auto split_encroached = [&](const std::function<void(int)>& push) {
+        while(!encroached.empty()) {
+            std::array<int, 2> e{encroached.back()};
+            encroached.pop_back();
+            // Stale entries: the segment was already split
+            if(!constraints.count(edge_key(e[0], e[1])) || split_segment(e[0], e[1]) == -1) {
+                continue;
+            }
+            TRIMESH_STATS(stats.segment_splits++;)
+            for(int t: insertion.created) {
+                push(t);
+                check_encroached(t);
+            }
+        }
+    };
+
+    // Queue every final triangle that breaks the rule of the phase, the quality rule in blocks through the
+    // minimum angle kernel
+    auto scan = [&](const std::function<void(int)>& push) {
+        TRIMESH_STATS(stats.rescans++;)
+        if(quality_phase) {
+            update_final();
+            std::array<double, 256> cosines;
+            for_each_block(final_triangles, xs, ys, [&](const Kernels::TriangleBlock& block, size_t first) {
+                Kernels::min_angle_cosines(block, cosines.data());
+                for(size_t i{0}; i < block.count; i++) {
+                    queue_bad(final_positions[first + i], cosines[i]);
+                }
+            });
+        } else {
+            for(size_t t{0}; t < triangles.size(); t++) {
+                push(t);
+            }
+        }
+        for(size_t t{0}; t < triangles.size(); t++) {
+            check_encroached(t);
+        }
+    };
+
+    // Insert circumcenters until the queue is empty
+    auto process = [&](const std::function<void(int)>& push) {
+        scan(push);
+        std::vector<int> cavity;
+        while(true) {
+            split_encroached(push);
+            if(queue.empty()) {
+                break;
+            }
+            RefineItem item{queue.top()};
+            queue.pop();
+            // Stale entries: the triangle was removed by a previous insertion
+            if(triangles[item.t] != item.vertices) {
+                TRIMESH_STATS(stats.stale_items++;)
+                continue;
+            }
+            Coord2D center{steiner_point(item.t)};
+            if(!constraints.empty()) {
+                // The circumcenter must be reached without crossing a segment and must not encroach any,
+                // otherwise those segments are split and the triangle is evaluated again
+                long long blocking;
+                int steps;
+                int target{walk(item.t, center, blocking, steps)};
+                TRIMESH_STATS(stats.walks++; stats.walk_steps += steps; stats.max_walk = std::max<long long>(stats.max_walk, steps);)
+                bool rejected{target == -1};
+                size_t pending{encroached.size()};
+                if(blocking != -1) {
+                    std::array<int, 2> e{edge_vertices(blocking)};
+                    if(splittable(e[0], e[1])) {
+                        encroached.push_back(e);
+                    }
+                } else if(target != -1) {
+                    find_cavity(target, center, cavity);
+                    for(int t: cavity) {
+                        for(int k{0}; k < 3; k++) {
+                            int a{triangles[t][(k+1)%3]}, b{triangles[t][(k+2)%3]};
+                            if(is_constrained(t, k) && encroaches(point(a), point(b), center)) {
+                                rejected = true;
+                                if(splittable(a, b)) {
+                                    encroached.push_back({a, b});
+                                }
+                            }
+                        }
+                    }
+                }
+                if(rejected) {
+                    if(encroached.size() > pending) {
+                        queue.push(item);
+                        TRIMESH_STATS(stats.requeued_items++;)
+                    }
+                    continue;
+                }
+                last_triangle = target;
+            }
+            // if the circumcenter cannot be inserted the triangle is skipped
+            if(!add_steiner_point(center)) {
+                continue;
+            }
+            TRIMESH_STATS((quality_phase ? stats.quality_points : stats.size_points)++;)
+            for(int t: insertion.created) {
+                push(t);
+                check_encroached(t);
+            }
+        }
+    };
+
+    // Parallel rounds: the best queued triangles are evaluated concurrently (circumcenter location,
+    // cavity and encroached segments), then a conflict-free subset is selected in queue order and
+    // filled concurrently. Selected points lock their cavity, the triangles around it and the refined
+    // triangle: no other point of the round touches them, so every cavity is the same as if the points
+    // were inserted one after the other. The result does not depend on the number of threads.
+    struct Candidate {
+        RefineItem item;
+        Coord2D center;
+        int status; // insert, skip, rejected (encroached segments), serial (walk failed)
+        int walk_steps;
+        Cavity cavity;
+        std::vector<std::array<int, 2>> encroached;
+    };
+    enum { insert_point, skip_point, reject_point, serial_point };
+    const size_t batch{256};
+    std::vector<Candidate> candidates(batch);
+    std::vector<int> locks; // round that locked every triangle
+    int round{0};
+
+    // Read-only evaluation of a candidate (runs concurrently)
+    auto evaluate = [&](size_t i) {
+        Candidate& c{candidates[i]};
+        c.encroached.clear();
+        // Candidates are reused across rounds: the point is copied by coordinates
+        Coord2D center{steiner_point(c.item.t)};
+        c.center.x = center.x;
+        c.center.y = center.y;
+        long long blocking;
+        int target{walk(c.item.t, c.center, blocking, c.walk_steps)};
+        if(blocking != -1) {
+            std::array<int, 2> e{edge_vertices(blocking)};
+            if(splittable(e[0], e[1])) {
+                c.encroached.push_back(e);
+            }
+            c.status = reject_point;
+            return;
+        }
+        if(target == -1) {
+            c.status = constraints.empty() ? serial_point : skip_point;
+            return;
+        }
+        for(int vertex: triangles[target]) {
+            if(point(vertex) == c.center) {
+                c.status = skip_point;
+                return;
+            }
+        }
+        collect_cavity(target, c.center, c.cavity.removed);
+        c.status = insert_point;
+        for(int t: c.cavity.removed) {
+            for(int k{0}; k < 3 && !constraints.empty(); k++) {
+                int a{triangles[t][(k+1)%3]}, b{triangles[t][(k+2)%3]};
+                if(is_constrained(t, k) && encroaches(point(a), point(b), c.center)) {
+                    c.status = reject_point;
+                    if(splittable(a, b)) {
+                        c.encroached.push_back({a, b});
+                    }
+                }
+            }
+        }
+        if(c.status == insert_point) {
+            find_boundary(c.cavity, false);
+        }
+    };
+
+    auto process_rounds = [&](const std::function<void(int)>& push) {
+        scan(push);
+        std::vector<size_t> selected;
+        std::vector<RefineItem> serial;
+        while(true) {
+            split_encroached(push);
+            if(queue.empty()) {
+                break;
+            }
+
+            // Best valid items of the queue
+            size_t count{0};
+            while(count < batch && !queue.empty()) {
+                RefineItem item{queue.top()};
+                queue.pop();
+                if(triangles[item.t] == item.vertices) {
+                    candidates[count++].item = item;
+                } else {
+                    TRIMESH_STATS(stats.stale_items++;)
+                }
+            }
+            parallel_for(threads, count, evaluate, stats);
+
+            // Select non-overlapping cavities in queue order, conflicting items wait for the next round
+            round++;
+            locks.resize(triangles.size(), 0);
+            selected.clear();
+            serial.clear();
+            for(size_t i{0}; i < count; i++) {
+                Candidate& c{candidates[i]};
+                TRIMESH_STATS(
+                    stats.walks++;
+                    stats.walk_steps += c.walk_steps;
+                    stats.max_walk = std::max<long long>(stats.max_walk, c.walk_steps);
+                )
+                if(c.status == skip_point) {
+                    continue;
+                }
+                if(c.status == serial_point) {
+                    serial.push_back(c.item);
+                    continue;
+                }
+                if(c.status == reject_point) {
+                    encroached.insert(encroached.end(), c.encroached.begin(), c.encroached.end());
+                    if(!c.encroached.empty()) {
+                        queue.push(c.item);
+                        TRIMESH_STATS(stats.requeued_items++;)
+                    }
+                    continue;
+                }
+                bool available{locks[c.item.t] != round};
+                for(int t: c.cavity.removed) {
+                    available = available && locks[t] != round;
+                }
+                for(const std::array<int, 3>& edge: c.cavity.boundary) {
+                    available = available && (edge[2] == -1 || locks[edge[2]] != round);
+                }
+                if(!available) {
+                    queue.push(c.item);
+                    TRIMESH_STATS(stats.requeued_items++;)
+                    continue;
+                }
+                locks[c.item.t] = round;
+                for(int t: c.cavity.removed) {
+                    locks[t] = round;
+                }
+                for(const std::array<int, 3>& edge: c.cavity.boundary) {
+                    if(edge[2] != -1) {
+                        locks[edge[2]] = round;
+                    }
+                }
+                selected.push_back(i);
+            }
+
+            // Nodes and new slots are assigned in selection order before filling the cavities
+            invalidate_final();
+            int first_node{get_nodes_count()};
+            for(size_t i: selected) {
+                Candidate& c{candidates[i]};
+                xs.push_back(c.center.x);
+                ys.push_back(c.center.y);
+                c.cavity.slots.clear();
+                for(size_t j{c.cavity.removed.size()}; j < c.cavity.boundary.size(); j++) {
+                    c.cavity.slots.push_back(new_slot());
+                }
+            }
+            parallel_for(threads, selected.size(), [&](size_t j) {
+                fill_cavity(first_node + j, candidates[selected[j]].cavity);
+            }, stats);
+            for(size_t i: selected) {
+                Cavity& cavity{candidates[i].cavity};
+                for(size_t j{cavity.boundary.size()}; j < cavity.removed.size(); j++) {
+                    free_slot(cavity.removed[j]);
+                }
+                TRIMESH_STATS(
+                    stats.insertions++;
+                    stats.cavity_triangles += cavity.removed.size();
+                    stats.max_cavity = std::max<long long>(stats.max_cavity, cavity.removed.size());
+                    stats.triangles_created += cavity.created.size();
+                    stats.triangles_destroyed += cavity.removed.size();
+                    (quality_phase ? stats.quality_points : stats.size_points)++;
+                )
+                for(int t: cavity.created) {
+                    push(t);
+                    check_encroached(t);
+                }
+            }
+            if(!selected.empty()) {
+                last_triangle = candidates[selected.back()].cavity.created.front();
+            }
+
+            // Circumcenters the walk did not reach are located from scratch
+            for(const RefineItem& item: serial) {
+                if(triangles[item.t] != item.vertices || !add_steiner_point(steiner_point(item.t))) {
+                    continue;
+                }
+                TRIMESH_STATS((quality_phase ? stats.quality_points : stats.size_points)++;)
+                for(int t: insertion.created) {
+                    push(t);
+                    check_encroached(t);
+                }
+            }
+        }
+    };
+
+    // refine bad triangles as long as there are bad triangles, then big triangles -> "new bad triangles"
+    auto refine_phase = [&](const std::function<void(int)>& push) {
+        if(threads == 1) {
+            process(push);
+        } else {
+            process_rounds(push);
+        }
+    };
+    {
+        TRIMESH_TIMER(stats.refine_quality_ms);
+        refine_phase(push_bad);
+    }
+    quality_phase = false;
+    {
+        TRIMESH_TIMER(stats.refine_size_ms);
+        refine_phase(push_big);
+    }
+
+    // Drop removed slots and spare capacity
+    compact();
+
+    // return refined triangles
+    return get_triangles();
+}
+
+// Refinement with a uniform element size h
+std::vector<Triangle> Delaunay::refine(double alpha, double h, int threads, Placement placement) {
+    return refine(alpha, [h](const Coord2D&) { return h; }, threads, placement);
+}
+
+// Replace the edge opposite to vertex k of t by the other diagonal of the quadrilateral formed with the
+// neighbor across it (both triangles keep their slots)
+void Delaunay::flip(int t, int k) {
+    int u{neighbors[t][k]};
+    int j{0};
+    while(neighbors[u][j] != t) {
+        j++;
+    }
+    int a{triangles[t][k]}, p{triangles[t][(k+1)%3]}, q{triangles[t][(k+2)%3]}, d{triangles[u][j]};
+    int outer_ap{neighbors[t][(k+2)%3]}, outer_aq{neighbors[t][(k+1)%3]};
+    int outer_dp{neighbors[u][vertex_position(u, q)]}, outer_dq{neighbors[u][vertex_position(u, p)]};
+    set_triangle(t, {a, p, d}, {outer_dp, u, outer_ap});
+    set_triangle(u, {a, q, d}, {outer_dq, t, outer_aq});
+    replace_neighbor(outer_dp, u, t);
+    replace_neighbor(outer_aq, t, u);
+    invalidate_final();
+    TRIMESH_STATS(stats.triangles_created += 2; stats.triangles_destroyed += 2;)
+}
+
+// Lawson flips from the stacked triangles: an edge is flipped while the opposite vertex of the neighbor lies
+// inside the circumcircle. Constrained edges and edges between the domain and its exterior are kept.
+int Delaunay::legalize(std::vector<int>& stack) {
+    int count{0};
+    while(!stack.empty()) {
+        int t{stack.back()};
+        stack.pop_back();
+        if(is_removed(t)) {
+            continue;
+        }
+        for(int k{0}; k < 3; k++) {
+            int u{neighbors[t][k]};
+            if(u < 0 || is_constrained(t, k) || (!exterior.empty() && exterior[t] != exterior[u])) {
+                continue;
+            }
+            int j{0};
+            while(neighbors[u][j] != t) {
+                j++;
+            }
+            Coord2D d{point(triangles[u][j])};
+            if(!circumscribe(t, d)) {
+                continue;
+            }
+            // The new diagonal has to cross the edge (convex quadrilateral)
+            Coord2D a{point(triangles[t][k])}, p{point(triangles[t][(k+1)%3])}, q{point(triangles[t][(k+2)%3])};
+            if(Predicates::orient2d(a, d, p) * Predicates::orient2d(a, d, q) >= 0) {
+                continue;
+            }
+            flip(t, k);
+            count++;
+            stack.push_back(t);
+            stack.push_back(u);
+            break;
+        }
+    }
+    return count;
+}
+
+// Counters and phase timers collected so far (see Stats)
+const Stats& Delaunay::get_stats() const {
+    return stats;
+}
+
+void Delaunay::reset_stats() {
+    stats = Stats{};
+}
+
+// Smoothing of the interior nodes: nodes of constrained edges and of triangles outside the final mesh (hull
+// and exterior) are fixed. Free nodes are colored so that nodes of a color are never adjacent and every color
+// moves in parallel without locks. A move is kept if no incident triangle is inverted and their lowest angle
+// does not decrease. Lawson flips restore the Delaunay property after every iteration (optional).
+std::vector<SmoothingStep> Delaunay::smooth(int iterations, Smoother smoother, bool flips, int threads) {
+    if(threads <= 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    TRIMESH_STATS(PredicateScope predicates{stats};)
+    int n{get_nodes_count()};
+    std::vector<SmoothingStep> steps;
+    auto quality = [&](int iteration, int moved, int flipped) {
+        double lowest{std::numeric_limits<double>::infinity()}, sum{0};
+        int count{0};
+        update_final();
+        std::array<double, 256> cosines;
+        for_each_block(final_triangles, xs, ys, [&](const Kernels::TriangleBlock& block, size_t) {
+            Kernels::min_angle_cosines(block, cosines.data());
+            for(size_t i{0}; i < block.count; i++) {
+                double angle{std::acos(std::min(1.0, cosines[i]))};
+                lowest = std::min(lowest, angle);
+                sum += angle;
+                count++;
+            }
+        });
+        steps.push_back(SmoothingStep{iteration, count ? lowest : 0, count ? sum / count : 0, moved, flipped});
+    };
+    quality(0, 0, 0);
+
+    // Incident triangles of every node (stars) and nodes of every color, both as offsets into flat arrays
+    std::vector<int> star_start, stars, fill;
+    std::vector<int> colors, color_start, color_nodes;
+    std::vector<char> fixed, used, moved;
+    std::vector<int> stack;
+
+    // New position of a free node (false if the move is rejected)
+    auto relocate = [&](int v) {
+        double x{0}, y{0}, weight{0};
+        for(int s{star_start[v]}; s < star_start[v + 1]; s++) {
+            const std::array<int, 3>& tv{triangles[stars[s]]};
+            if(smoother == Smoother::laplacian) {
+                // Every neighbor is counted twice (once per incident triangle of the edge)
+                for(int w: tv) {
+                    if(w != v) {
+                        x += xs[w+3];
+                        y += ys[w+3];
+                        weight += 1;
+                    }
+                }
+            } else {
+                double a{area(stars[s])};
+                Coord2D c{circumcenter(point(tv[0]), point(tv[1]), point(tv[2]))};
+                x += a*c.x;
+                y += a*c.y;
+                weight += a;
+            }
+        }
+        if(!(weight > 0)) {
+            return false;
+        }
+        Coord2D target{x / weight, y / weight};
+        if(target == point(v)) {
+            return false;
+        }
+        double before{std::numeric_limits<double>::infinity()}, after{std::numeric_limits<double>::infinity()};
+        for(int s{star_start[v]}; s < star_start[v + 1]; s++) {
+            const std::array<int, 3>& tv{triangles[stars[s]]};
+            std::array<Coord2D, 3> current{point(tv[0]), point(tv[1]), point(tv[2])};
+            int k{vertex_position(stars[s], v)};
+            std::array<Coord2D, 3> next{(k == 0) ? target : current[0], (k == 1) ? target : current[1],
+                                        (k == 2) ? target : current[2]};
+            double orientation{Predicates::orient2d(next[0], next[1], next[2])};
+            if(orientation == 0 || (orientation > 0) != (Predicates::orient2d(current[0], current[1], current[2]) > 0)) {
+                return false;
+            }
+            before = std::min(before, min_angle(current[0], current[1], current[2]));
+            after = std::min(after, min_angle(next[0], next[1], next[2]));
+        }
+        if(after < before) {
+            return false;
+        }
+        xs[v+3] = target.x;
+        ys[v+3] = target.y;
+        return true;
+    };
+
+    // Workers created once and synchronized after every color (no threads if threads is 1)
+    WorkerPool pool{threads, stats};
+    for(int iteration{1}; iteration <= iterations; iteration++) {
+        // Stars (rebuilt since flips change them) and fixed nodes
+        star_start.assign(n + 1, 0);
+        fixed.assign(n, 0);
+        for(size_t t{0}; t < triangles.size(); t++) {
+            if(is_removed(t)) {
+                continue;
+            }
+            for(int v: triangles[t]) {
+                if(v >= 0) {
+                    star_start[v + 1]++;
+                    fixed[v] |= !is_final(t);
+                }
+            }
+        }
+        std::partial_sum(star_start.begin(), star_start.end(), star_start.begin());
+        stars.resize(star_start[n]);
+        fill.assign(star_start.begin(), star_start.end() - 1);
+        for(size_t t{0}; t < triangles.size(); t++) {
+            if(is_removed(t)) {
+                continue;
+            }
+            for(int v: triangles[t]) {
+                if(v >= 0) {
+                    stars[fill[v]++] = t;
+                }
+            }
+        }
+        for(long long key: constraints) {
+            std::array<int, 2> e{edge_vertices(key)};
+            fixed[e[0]] = 1;
+            fixed[e[1]] = 1;
+        }
+
+        // Greedy coloring of the free nodes
+        colors.assign(n, -1);
+        int color_count{0};
+        for(int v{0}; v < n; v++) {
+            if(fixed[v]) {
+                continue;
+            }
+            used.assign(color_count + 1, 0);
+            for(int s{star_start[v]}; s < star_start[v + 1]; s++) {
+                for(int w: triangles[stars[s]]) {
+                    if(w >= 0 && w != v && colors[w] >= 0) {
+                        used[colors[w]] = 1;
+                    }
+                }
+            }
+            colors[v] = std::find(used.begin(), used.end(), 0) - used.begin();
+            color_count = std::max(color_count, colors[v] + 1);
+        }
+        color_start.assign(color_count + 1, 0);
+        for(int v{0}; v < n; v++) {
+            if(colors[v] >= 0) {
+                color_start[colors[v] + 1]++;
+            }
+        }
+        std::partial_sum(color_start.begin(), color_start.end(), color_start.begin());
+        color_nodes.resize(color_start[color_count]);
+        fill.assign(color_start.begin(), color_start.end() - 1);
+        for(int v{0}; v < n; v++) {
+            if(colors[v] >= 0) {
+                color_nodes[fill[colors[v]]++] = v;
+            }
+        }
+
+        // Nodes of a color only read nodes of other colors
+        moved.assign(n, 0);
+        for(int c{0}; c < color_count; c++) {
+            pool.run(color_start[c + 1] - color_start[c], [&](size_t i) {
+                int v{color_nodes[color_start[c] + i]};
+                moved[v] = relocate(v);
+            });
+        }
+        int moved_count{static_cast<int>(std::count(moved.begin(), moved.end(), 1))};
+        pool.run(triangles.size(), [&](size_t t) {
+            if(!is_removed(t)) {
+                update_circle(t);
+            }
+        });
+
+        int flipped{0};
+        if(flips) {
+            stack.clear();
+            for(size_t t{0}; t < triangles.size(); t++) {
+                if(!is_removed(t)) {
+                    stack.push_back(t);
+                }
+            }
+            flipped = legalize(stack);
+        }
+        quality(iteration, moved_count, flipped);
+        if(moved_count == 0 && flipped == 0) {
+            break;
+        }
+    }
+    return steps;
+}
@@ -2,6 +2,13 @@
 #include <array>
 #include <iostream>
 #include <set>
+#include <unordered_set>
+#include <string>
+#include <functional>
+#include <mutex>
+#include <atomic>
+
+#include <Stats.hpp>
 
 #ifndef _DELAUNAY_HPP_
 #define _DELAUNAY_HPP_
@@ -77,35 +84,217 @@ public:
     friend std::ostream& operator<<(std::ostream& os, const Triangle& t);
 };
 
+// Circumcircle of a triangle: center, squared radius and error bound used to filter in-circle checks
+struct Circumcircle {
+    double x;
+    double y;
+    double r2;
+    double error;
+};
+
+// Target element size at a point: triangles bigger than the right isosceles triangle with this leg
+// length are refined
+using SizeField = std::function<double(const Coord2D&)>;
+
+// Steiner points of the quality refinement: circumcenter of the bad triangle or off-center, the point on
+// the bisector of its shortest edge where the new triangle just meets the angle bound (Üngör, 2004)
+enum class Placement { circumcenter, offcenter };
+
+// Node insertion algorithm: Bowyer-Watson (cavity of the triangles whose circumcircle contains the node
+// replaced by a star) or Lawson (containing triangle split and edges flipped until Delaunay)
+enum class Engine { bowyer_watson, lawson };
+
+// Node relocation of the smoothing stage: average of the neighbors (Laplacian) or area weighted average of
+// the circumcenters of the incident triangles (optimal Delaunay triangulation, Chen 2004)
+enum class Smoother { laplacian, odt };
+
+// Quality after a smoothing iteration (iteration 0 is the mesh before smoothing): lowest and mean minimum
+// angle of the final triangles, nodes moved and edges flipped
+struct SmoothingStep {
+    int iteration;
+    double min_angle;
+    double mean_angle;
+    int moved;
+    int flips;
+};
+
+// Result of a batch insertion: node index of every input point (-1 if it was not inserted), and final
+// triangles created and destroyed by the whole batch as node indices (see get_triangles_index)
+struct Insertion {
+    std::vector<int> nodes;
+    std::vector<std::array<int, 3>> created;
+    std::vector<std::array<int, 3>> destroyed;
+};
+
+// Read-only view over contiguous elements owned by another object (valid while the owner is not modified)
+template<typename T>
+class View {
+    const T* first;
+    size_t count;
+public:
+    View() : first{nullptr}, count{0} {}
+    View(const T* first, size_t count) : first{first}, count{count} {}
+    const T* begin() const { return first; }
+    const T* end() const { return first + count; }
+    const T* data() const { return first; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const T& operator[](size_t i) const { return first[i]; }
+};
+
 class Delaunay
 {
-    std::vector<Node> nodes;
-    std::vector<Triangle> triangles{};
-    Triangle super_triangle();
+    friend class MeshView;
+    friend class Export;
+    // Node coordinates: super triangle nodes (-3, -2, -1) are stored first
+    std::vector<double> xs{0, 0, 0};
+    std::vector<double> ys{0, 0, 0};
+    // Triangles as node indices in increasing order (super triangle nodes are negative)
+    std::vector<std::array<int, 3>> triangles{};
+    // neighbors[t][k] is the triangle across the edge opposite to vertex k of t (-1 if none)
+    std::vector<std::array<int, 3>> neighbors{};
+    // Circumcircles computed once when triangles are created
+    std::vector<Circumcircle> circles{};
+    // Node insertion algorithm
+    Engine engine{Engine::bowyer_watson};
+    // Counters and phase timers (only updated with TRIMESH_ENABLE_STATS)
+    Stats stats{};
+    // Triangle where point location walks start from
+    int last_triangle{0};
+    // Visit marks for cavity search (triangle is visited if its mark equals stamp)
+    std::vector<int> marks{};
+    int stamp{0};
+    // Triangles removed and created by an insertion, with the buffers used to replace them
+    struct Cavity {
+        std::vector<int> removed{};
+        std::vector<std::array<int, 3>> boundary{}; // {edge vertex, edge vertex, outer triangle}
+        std::vector<char> regions{}; // exterior flag of the removed triangle of every boundary edge
+        std::vector<int> slots{}; // slots of the new triangles beyond the removed ones
+        std::vector<std::pair<int, int>> pending{}; // {boundary vertex, new triangle}
+        std::vector<int> created{};
+    };
+    // Last insertion (kept to avoid allocations on every node)
+    Cavity insertion{};
+    // Slots of removed triangles (tombstones) reused by new triangles until the next compaction
+    std::vector<int> free_slots{};
+    // Final triangles removed by insertions (only recorded during batch insertions)
+    bool record_removed{false};
+    std::vector<std::array<int, 3>> removed_triangles{};
+    // Constrained mode: input segments, recovered constrained edges (edge keys) and exterior flag
+    // of every triangle (outside the domain or inside a hole)
+    std::vector<Edge> segments{};
+    std::unordered_set<long long> constraints{};
+    std::vector<char> exterior{};
+    // Final triangles cache (positions, vertices and unique edges), rebuilt on the first read after a
+    // change. Const getters fill it under a lock, so concurrent readers are safe (writers are not).
+    struct CacheState {
+        std::mutex mutex{};
+        std::atomic<bool> final_cached{false};
+        std::atomic<bool> edges_cached{false};
+        CacheState() = default;
+        CacheState(const CacheState& other) : final_cached{other.final_cached.load()}, edges_cached{other.edges_cached.load()} {}
+        CacheState& operator=(const CacheState& other) {
+            final_cached = other.final_cached.load();
+            edges_cached = other.edges_cached.load();
+            return *this;
+        }
+    };
+    mutable std::vector<int> final_positions{};
+    mutable std::vector<std::array<int, 3>> final_triangles{};
+    mutable std::vector<std::array<int, 2>> final_edges{};
+    mutable CacheState cache{};
+    void invalidate_final();
+    void update_final() const;
+    void update_edges() const;
+    static long long edge_key(int a, int b);
+    void super_triangle();
+    Coord2D point(int v) const;
+    Triangle triangle(int t) const;
+    bool is_final(int t) const;
+    bool is_removed(int t) const;
+    int new_slot();
+    void free_slot(int t);
+    int vertex_position(int t, int v) const;
+    void update_circle(int t);
+    void update_circles();
+    bool circumscribe(int t, const Coord2D& p) const;
+    bool is_constrained(int t, int k) const;
+    double area(int t) const;
+    bool is_big(int t, const SizeField& size) const;
+    Coord2D offcenter(int t, double alpha) const;
+    void build_neighbors();
+    int find_triangle(const Triangle& t) const;
+    int locate(const Coord2D& p);
+    int walk(int t, const Coord2D& p, long long& blocking, int& steps) const;
+    void find_cavity(int first, const Coord2D& p, std::vector<int>& cavity);
+    void collect_cavity(int first, const Coord2D& p, std::vector<int>& cavity) const;
+    void find_boundary(Cavity& cavity, bool marked) const;
+    void fill_cavity(int v, Cavity& cavity);
+    std::vector<Triangle> compute_serial(bool sorted);
+    int insert(int v);
+    int insert_flip(int v, int first);
+    void set_triangle(int t, std::array<int, 3> v, std::array<int, 3> n);
+    void replace_neighbor(int t, int from, int to);
+    int find_vertex(const Coord2D& p);
+    void recover_segment(int a, int b);
+    void triangulate_polygon(int a, int b, const std::vector<int>& chain, std::vector<std::array<int, 3>>& result) const;
+    void mark_exterior();
+    void apply_constraints();
+    int split_segment(int a, int b);
+    bool add_steiner_point(Coord2D p);
+    void flip(int t, int k);
+    int legalize(std::vector<int>& stack);
 public:
     Delaunay();
-    Delaunay(std::vector<Coord2D> points);
+    explicit Delaunay(Engine engine);
+    Delaunay(std::vector<Coord2D> points, Engine engine=Engine::bowyer_watson);
+    Delaunay(std::vector<Coord2D> points, std::vector<Edge> segments, Engine engine=Engine::bowyer_watson);
     Delaunay(std::vector<Triangle> triangles, std::vector<Node> nodes);
     ~Delaunay();
-    std::vector<Triangle> compute();
+    std::vector<Triangle> compute(bool sorted=true);
+    std::vector<Triangle> compute_parallel(int threads=0);
+    void compact();
     Triangle add_point(double x, double y);
     Triangle add_point(Coord2D p);
     Triangle add_point(Node p);
+    Insertion add_points(const std::vector<Coord2D>& points);
+    int get_nodes_count() const;
     std::vector<Node> get_nodes() const;
     std::vector<Edge> get_edges() const;
     std::vector<std::array<int, 2>> get_edges_index() const;
     std::vector<Triangle> get_triangles() const;
     std::vector<std::array<int, 3>> get_triangles_index() const;
-    std::vector<std::pair<Triangle, Edge>> get_neighbors(Triangle t);
-    std::vector<Triangle> refine(double alpha, double h);
-    std::vector<Triangle> get_bad_triangles(double alpha);
-    std::vector<Triangle> get_big_triangles(double h);
+    // Read-only views (no copies), valid until the triangulation is modified
+    View<double> get_x() const;
+    View<double> get_y() const;
+    View<std::array<int, 3>> get_triangles_view() const;
+    View<std::array<int, 2>> get_edges_view() const;
+    std::vector<std::pair<Triangle, Edge>> get_neighbors(Triangle t) const;
+    std::vector<std::array<int, 3>> get_neighbors_index() const;
+    std::vector<std::array<int, 2>> get_constraints_index() const;
+    Delaunay extract_domain() const;
+    void save(const std::string& filename, bool adjacency=true) const;
+    const Stats& get_stats() const;
+    void reset_stats();
+    std::vector<Coord2D> get_circumcenters() const;
+    std::vector<double> get_circumradii() const;
+    std::vector<Triangle> refine(double alpha, double h, int threads=1, Placement placement=Placement::circumcenter);
+    std::vector<Triangle> refine(double alpha, const SizeField& size, int threads=1, Placement placement=Placement::circumcenter);
+    std::vector<SmoothingStep> smooth(int iterations, Smoother smoother=Smoother::odt, bool flips=true, int threads=1);
+    std::vector<Triangle> get_bad_triangles(double alpha) const;
+    std::vector<Triangle> get_big_triangles(double h) const;
+    std::vector<Triangle> get_big_triangles(const SizeField& size) const;
 };
 
 
 double dist(const Coord2D& p1, const Coord2D& p2);
 Coord2D midpoint(const Coord2D& p1, const Coord2D& p2);
 double slope(const Coord2D& p1, const Coord2D& p2);
+Coord2D circumcenter(const Coord2D& v1, const Coord2D& v2, const Coord2D& v3);
+bool in_circumcircle(const Coord2D& a, const Coord2D& b, const Coord2D& c, const Coord2D& p);
+double min_angle(const Coord2D& v1, const Coord2D& v2, const Coord2D& v3);
+double area(const Coord2D& v1, const Coord2D& v2, const Coord2D& v3);
+std::vector<int> spatial_order(const std::vector<Coord2D>& points);
 
 
 #endif // _DELAUNAY_HPP_
\ No newline at end of file
@@ -0,0 +1,376 @@
+#include <vector>
+#include <array>
+#include <string>
+#include <fstream>
+#include <charconv>
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+#include <algorithm>
+#include <initializer_list>
+
+#include <Export.hpp>
+#include <Delaunay.hpp>
+#include <Predicates.hpp>
+
+static bool little_endian() {
+    uint16_t one{1};
+    return *reinterpret_cast<const char*>(&one) == 1;
+}
+
+// Output file written in chunks from a fixed size buffer
+class OutputBuffer {
+    std::ofstream file;
+    std::vector<char> data;
+    size_t used{0};
+    std::string filename;
+
+    void reserve(size_t size) {
+        if(used + size > data.size()) {
+            flush();
+        }
+    }
+public:
+    OutputBuffer(const std::string& filename)
+        : file{filename, std::ios::binary}, data(1 << 20), filename{filename} {
+        if(!file) {
+            throw std::runtime_error("Cannot open " + filename);
+        }
+    }
+
+    void write(const void* bytes, size_t size) {
+        if(size > data.size()) {
+            flush();
+            file.write(static_cast<const char*>(bytes), size);
+            return;
+        }
+        reserve(size);
+        std::memcpy(data.data() + used, bytes, size);
+        used += size;
+    }
+
+    void text(const std::string& value) {
+        write(value.data(), value.size());
+    }
+
+    // Shortest representation that reads back to the same value
+    template<typename T>
+    void number(T value) {
+        reserve(32);
+        std::to_chars_result result{std::to_chars(data.data() + used, data.data() + data.size(), value)};
+        used = result.ptr - data.data();
+    }
+
+    void character(char value) {
+        reserve(1);
+        data[used++] = value;
+    }
+
+    // Binary value in the given byte order
+    template<typename T>
+    void binary(T value, bool big_endian=false) {
+        char bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+        if(big_endian == little_endian()) {
+            std::reverse(bytes, bytes + sizeof(T));
+        }
+        write(bytes, sizeof(T));
+    }
+
+    void flush() {
+        file.write(data.data(), used);
+        used = 0;
+    }
+
+    void close() {
+        flush();
+        file.close();
+        if(!file) {
+            throw std::runtime_error("Cannot write " + filename);
+        }
+    }
+};
+
+size_t Export::count_final(const Delaunay& d) {
+    size_t count{0};
+    for(size_t t{0}; t < d.triangles.size(); t++) {
+        count += d.is_final(t);
+    }
+    return count;
+}
+
+template<typename F>
+void Export::for_each_final(const Delaunay& d, F f) {
+    for(size_t t{0}; t < d.triangles.size(); t++) {
+        if(!d.is_final(t)) {
+            continue;
+        }
+        std::array<int, 3> v{d.triangles[t]};
+        if(Predicates::orient2d(d.point(v[0]), d.point(v[1]), d.point(v[2])) < 0) {
+            std::swap(v[1], v[2]);
+        }
+        f(v);
+    }
+}
+
+void Export::vtk(const Delaunay& d, const std::string& filename, bool binary) {
+    OutputBuffer out{filename};
+    int n{d.get_nodes_count()};
+    size_t count{count_final(d)};
+    out.text("# vtk DataFile Version 3.0\ntrimesh\n");
+    out.text(binary ? "BINARY\n" : "ASCII\n");
+    out.text("DATASET UNSTRUCTURED_GRID\nPOINTS " + std::to_string(n) + " double\n");
+    for(int v{0}; v < n; v++) {
+        if(binary) {
+            out.binary(d.xs[v+3], true);
+            out.binary(d.ys[v+3], true);
+            out.binary(0.0, true);
+        } else {
+            out.number(d.xs[v+3]);
+            out.character(' ');
+            out.number(d.ys[v+3]);
+            out.text(" 0\n");
+        }
+    }
+
+    out.text((binary ? "\nCELLS " : "CELLS ") + std::to_string(count) + " " + std::to_string(4*count) + "\n");
+    for_each_final(d, [&](const std::array<int, 3>& v) {
+        if(binary) {
+            out.binary<int32_t>(3, true);
+            for(int i: v) {
+                out.binary<int32_t>(i, true);
+            }
+        } else {
+            out.character('3');
+            for(int i: v) {
+                out.character(' ');
+                out.number(i);
+            }
+            out.character('\n');
+        }
+    });
+
+    out.text((binary ? "\nCELL_TYPES " : "CELL_TYPES ") + std::to_string(count) + "\n");
+    for(size_t t{0}; t < count; t++) {
+        if(binary) {
+            out.binary<int32_t>(5, true);
+        } else {
+            out.text("5\n");
+        }
+    }
+    if(binary) {
+        out.character('\n');
+    }
+    out.close();
+}
+
+void Export::vtu(const Delaunay& d, const std::string& filename, bool binary) {
+    OutputBuffer out{filename};
+    uint64_t n{static_cast<uint64_t>(d.get_nodes_count())};
+    uint64_t count{count_final(d)};
+
+    // Appended blocks: byte count followed by the data
+    uint64_t points_size{24*n};
+    uint64_t connectivity_size{12*count};
+    uint64_t offsets_size{4*count};
+    uint64_t types_size{count};
+    std::array<uint64_t, 4> offsets{0};
+    offsets[1] = offsets[0] + 8 + points_size;
+    offsets[2] = offsets[1] + 8 + connectivity_size;
+    offsets[3] = offsets[2] + 8 + offsets_size;
+
+    auto data_array = [&](const std::string& attributes, int block) {
+        out.text("        <DataArray " + attributes);
+        if(binary) {
+            out.text(" format=\"appended\" offset=\"" + std::to_string(offsets[block]) + "\"/>\n");
+        } else {
+            out.text(" format=\"ascii\">\n");
+        }
+    };
+    auto end_array = [&]() {
+        if(!binary) {
+            out.text("        </DataArray>\n");
+        }
+    };
+
+    out.text("<?xml version=\"1.0\"?>\n");
+    out.text("<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\"");
+    out.text(little_endian() ? "LittleEndian" : "BigEndian");
+    out.text("\" header_type=\"UInt64\">\n  <UnstructuredGrid>\n");
+    out.text("    <Piece NumberOfPoints=\"" + std::to_string(n) + "\" NumberOfCells=\"" + std::to_string(count) + "\">\n");
+    out.text("      <Points>\n");
+    data_array("type=\"Float64\" NumberOfComponents=\"3\"", 0);
+    if(!binary) {
+        for(uint64_t v{0}; v < n; v++) {
+            out.number(d.xs[v+3]);
+            out.character(' ');
+            out.number(d.ys[v+3]);
+            out.text(" 0\n");
+        }
+    }
+    end_array();
+    out.text("      </Points>\n      <Cells>\n");
+    data_array("type=\"Int32\" Name=\"connectivity\"", 1);
+    if(!binary) {
+        for_each_final(d, [&](const std::array<int, 3>& v) {
+            out.number(v[0]);
+            out.character(' ');
+            out.number(v[1]);
+            out.character(' ');
+            out.number(v[2]);
+            out.character('\n');
+        });
+    }
+    end_array();
+    data_array("type=\"Int32\" Name=\"offsets\"", 2);
+    if(!binary) {
+        for(uint64_t t{1}; t <= count; t++) {
+            out.number(3*t);
+            out.character('\n');
+        }
+    }
+    end_array();
+    data_array("type=\"UInt8\" Name=\"types\"", 3);
+    if(!binary) {
+        for(uint64_t t{0}; t < count; t++) {
+            out.text("5\n");
+        }
+    }
+    end_array();
+    out.text("      </Cells>\n    </Piece>\n  </UnstructuredGrid>\n");
+
+    if(binary) {
+        out.text("  <AppendedData encoding=\"raw\">\n_");
+        out.write(&points_size, sizeof(uint64_t));
+        for(uint64_t v{0}; v < n; v++) {
+            double coords[3]{d.xs[v+3], d.ys[v+3], 0};
+            out.write(coords, sizeof(coords));
+        }
+        out.write(&connectivity_size, sizeof(uint64_t));
+        for_each_final(d, [&](const std::array<int, 3>& v) {
+            int32_t nodes[3]{v[0], v[1], v[2]};
+            out.write(nodes, sizeof(nodes));
+        });
+        out.write(&offsets_size, sizeof(uint64_t));
+        for(uint64_t t{1}; t <= count; t++) {
+            int32_t offset{static_cast<int32_t>(3*t)};
+            out.write(&offset, sizeof(int32_t));
+        }
+        out.write(&types_size, sizeof(uint64_t));
+        for(uint64_t t{0}; t < count; t++) {
+            out.character(5);
+        }
+        out.text("\n  </AppendedData>\n");
+    }
+    out.text("</VTKFile>\n");
+    out.close();
+}
+
+// Nodes: a single surface entity. Elements: constrained edges as lines followed by the triangles,
+// element tags are consecutive starting at 1.
+void Export::msh(const Delaunay& d, const std::string& filename, bool binary) {
+    OutputBuffer out{filename};
+    uint64_t n{static_cast<uint64_t>(d.get_nodes_count())};
+    uint64_t count{count_final(d)};
+    std::vector<std::array<int, 2>> segments{d.get_constraints_index()};
+    uint64_t elements{count + segments.size()};
+    uint64_t blocks{segments.empty() ? 1u : 2u};
+
+    // Binary integers are written as size_t (data size 8)
+    auto integers = [&](std::initializer_list<uint64_t> values) {
+        bool first{true};
+        for(uint64_t value: values) {
+            if(binary) {
+                out.write(&value, sizeof(uint64_t));
+            } else {
+                if(!first) {
+                    out.character(' ');
+                }
+                out.number(value);
+            }
+            first = false;
+        }
+        if(!binary) {
+            out.character('\n');
+        }
+    };
+    auto entity = [&](int32_t dim, int32_t tag, int32_t parametric_or_type, uint64_t size) {
+        if(binary) {
+            int32_t values[3]{dim, tag, parametric_or_type};
+            out.write(values, sizeof(values));
+            out.write(&size, sizeof(uint64_t));
+        } else {
+            out.text(std::to_string(dim) + " " + std::to_string(tag) + " " + std::to_string(parametric_or_type)
+                     + " " + std::to_string(size) + "\n");
+        }
+    };
+
+    out.text("$MeshFormat\n");
+    if(binary) {
+        int32_t one{1};
+        out.text("4.1 1 8\n");
+        out.write(&one, sizeof(int32_t));
+        out.character('\n');
+    } else {
+        out.text("4.1 0 8\n");
+    }
+    out.text("$EndMeshFormat\n");
+
+    out.text("$Nodes\n");
+    integers({1, n, 1, n});
+    entity(2, 1, 0, n);
+    for(uint64_t v{1}; v <= n; v++) {
+        integers({v});
+    }
+    for(uint64_t v{0}; v < n; v++) {
+        if(binary) {
+            double coords[3]{d.xs[v+3], d.ys[v+3], 0};
+            out.write(coords, sizeof(coords));
+        } else {
+            out.number(d.xs[v+3]);
+            out.character(' ');
+            out.number(d.ys[v+3]);
+            out.text(" 0\n");
+        }
+    }
+    out.text(binary ? "\n$EndNodes\n" : "$EndNodes\n");
+
+    out.text("$Elements\n");
+    integers({blocks, elements, 1, elements});
+    uint64_t tag{1};
+    if(!segments.empty()) {
+        entity(1, 1, 1, segments.size());
+        for(const std::array<int, 2>& s: segments) {
+            integers({tag++, static_cast<uint64_t>(s[0]) + 1, static_cast<uint64_t>(s[1]) + 1});
+        }
+    }
+    entity(2, 1, 2, count);
+    for_each_final(d, [&](const std::array<int, 3>& v) {
+        integers({tag++, static_cast<uint64_t>(v[0]) + 1, static_cast<uint64_t>(v[1]) + 1,
+                  static_cast<uint64_t>(v[2]) + 1});
+    });
+    out.text(binary ? "\n$EndElements\n" : "$EndElements\n");
+    out.close();
+}
+
+void Export::obj(const Delaunay& d, const std::string& filename) {
+    OutputBuffer out{filename};
+    int n{d.get_nodes_count()};
+    out.text("# trimesh\n");
+    for(int v{0}; v < n; v++) {
+        out.text("v ");
+        out.number(d.xs[v+3]);
+        out.character(' ');
+        out.number(d.ys[v+3]);
+        out.text(" 0\n");
+    }
+    for_each_final(d, [&](const std::array<int, 3>& v) {
+        out.character('f');
+        for(int i: v) {
+            out.character(' ');
+            out.number(i + 1);
+        }
+        out.character('\n');
+    });
+    out.close();
+}
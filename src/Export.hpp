@@ -0,0 +1,29 @@
+#include <string>
+#include <array>
+
+#include <Delaunay.hpp>
+
+#ifndef _EXPORT_HPP_
+#define _EXPORT_HPP_
+
+// Mesh exporters: final triangles are streamed from the triangulation storage through a buffer
+// written in chunks. Triangles are written counter-clockwise, constrained edges as line elements (msh).
+class Export {
+public:
+    // Legacy VTK unstructured grid (binary data is big endian as required by the format)
+    static void vtk(const Delaunay& d, const std::string& filename, bool binary=false);
+    // VTK XML unstructured grid (binary data goes in a raw appended section)
+    static void vtu(const Delaunay& d, const std::string& filename, bool binary=false);
+    // Gmsh msh 4.1
+    static void msh(const Delaunay& d, const std::string& filename, bool binary=false);
+    // Wavefront OBJ (text only)
+    static void obj(const Delaunay& d, const std::string& filename);
+private:
+    static size_t count_final(const Delaunay& d);
+    // Calls f with the counter-clockwise vertices of every final triangle
+    template<typename F>
+    static void for_each_final(const Delaunay& d, F f);
+};
+
+
+#endif //_EXPORT_HPP_
@@ -0,0 +1,120 @@
+#include <cmath>
+#include <cstddef>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define TRIMESH_AVX2_KERNELS
+#endif
+
+#include <Kernels.hpp>
+
+// Scalar kernels, also used for the tail of the blocks processed with AVX2
+double Kernels::min_angle_cosine(const Coord2D& a, const Coord2D& b, const Coord2D& c) {
+    // Squared length of the side opposite to every vertex
+    double bcx{c.x - b.x}, bcy{c.y - b.y};
+    double cax{a.x - c.x}, cay{a.y - c.y};
+    double abx{b.x - a.x}, aby{b.y - a.y};
+    double la{bcx*bcx + bcy*bcy}, lb{cax*cax + cay*cay}, lc{abx*abx + aby*aby};
+
+    // Cosine theorem at every vertex, the smallest angle has the largest cosine
+    double cos_a{(lb + lc - la) / (2 * std::sqrt(lb * lc))};
+    double cos_b{(lc + la - lb) / (2 * std::sqrt(lc * la))};
+    double cos_c{(la + lb - lc) / (2 * std::sqrt(la * lb))};
+    double largest{cos_a > cos_b ? cos_a : cos_b};
+    return largest > cos_c ? largest : cos_c;
+}
+
+double Kernels::signed_area(const Coord2D& a, const Coord2D& b, const Coord2D& c) {
+    return 0.5 * ((b.x - a.x)*(c.y - a.y) - (b.y - a.y)*(c.x - a.x));
+}
+
+static void min_angle_cosines_scalar(const Kernels::TriangleBlock& block, size_t begin, double* cosines) {
+    for(size_t i{begin}; i < block.count; i++) {
+        cosines[i] = Kernels::min_angle_cosine(Coord2D{block.ax[i], block.ay[i]}, Coord2D{block.bx[i], block.by[i]},
+                                               Coord2D{block.cx[i], block.cy[i]});
+    }
+}
+
+static void signed_areas_scalar(const Kernels::TriangleBlock& block, size_t begin, double* areas) {
+    for(size_t i{begin}; i < block.count; i++) {
+        areas[i] = Kernels::signed_area(Coord2D{block.ax[i], block.ay[i]}, Coord2D{block.bx[i], block.by[i]},
+                                        Coord2D{block.cx[i], block.cy[i]});
+    }
+}
+
+#ifdef TRIMESH_AVX2_KERNELS
+// Four triangles per iteration (no FMA: products are rounded as in the scalar kernels)
+__attribute__((target("avx2")))
+static void min_angle_cosines_avx2(const Kernels::TriangleBlock& block, double* cosines) {
+    size_t i{0};
+    const __m256d two{_mm256_set1_pd(2)};
+    for(; i + 4 <= block.count; i += 4) {
+        __m256d ax{_mm256_loadu_pd(block.ax + i)}, ay{_mm256_loadu_pd(block.ay + i)};
+        __m256d bx{_mm256_loadu_pd(block.bx + i)}, by{_mm256_loadu_pd(block.by + i)};
+        __m256d cx{_mm256_loadu_pd(block.cx + i)}, cy{_mm256_loadu_pd(block.cy + i)};
+        __m256d bcx{_mm256_sub_pd(cx, bx)}, bcy{_mm256_sub_pd(cy, by)};
+        __m256d cax{_mm256_sub_pd(ax, cx)}, cay{_mm256_sub_pd(ay, cy)};
+        __m256d abx{_mm256_sub_pd(bx, ax)}, aby{_mm256_sub_pd(by, ay)};
+        __m256d la{_mm256_add_pd(_mm256_mul_pd(bcx, bcx), _mm256_mul_pd(bcy, bcy))};
+        __m256d lb{_mm256_add_pd(_mm256_mul_pd(cax, cax), _mm256_mul_pd(cay, cay))};
+        __m256d lc{_mm256_add_pd(_mm256_mul_pd(abx, abx), _mm256_mul_pd(aby, aby))};
+        __m256d cos_a{_mm256_div_pd(_mm256_sub_pd(_mm256_add_pd(lb, lc), la),
+                                    _mm256_mul_pd(two, _mm256_sqrt_pd(_mm256_mul_pd(lb, lc))))};
+        __m256d cos_b{_mm256_div_pd(_mm256_sub_pd(_mm256_add_pd(lc, la), lb),
+                                    _mm256_mul_pd(two, _mm256_sqrt_pd(_mm256_mul_pd(lc, la))))};
+        __m256d cos_c{_mm256_div_pd(_mm256_sub_pd(_mm256_add_pd(la, lb), lc),
+                                    _mm256_mul_pd(two, _mm256_sqrt_pd(_mm256_mul_pd(la, lb))))};
+        // max_pd(x, y) is x > y ? x : y
+        _mm256_storeu_pd(cosines + i, _mm256_max_pd(_mm256_max_pd(cos_a, cos_b), cos_c));
+    }
+    min_angle_cosines_scalar(block, i, cosines);
+}
+
+__attribute__((target("avx2")))
+static void signed_areas_avx2(const Kernels::TriangleBlock& block, double* areas) {
+    size_t i{0};
+    const __m256d half{_mm256_set1_pd(0.5)};
+    for(; i + 4 <= block.count; i += 4) {
+        __m256d ax{_mm256_loadu_pd(block.ax + i)}, ay{_mm256_loadu_pd(block.ay + i)};
+        __m256d bx{_mm256_loadu_pd(block.bx + i)}, by{_mm256_loadu_pd(block.by + i)};
+        __m256d cx{_mm256_loadu_pd(block.cx + i)}, cy{_mm256_loadu_pd(block.cy + i)};
+        __m256d left{_mm256_mul_pd(_mm256_sub_pd(bx, ax), _mm256_sub_pd(cy, ay))};
+        __m256d right{_mm256_mul_pd(_mm256_sub_pd(by, ay), _mm256_sub_pd(cx, ax))};
+        _mm256_storeu_pd(areas + i, _mm256_mul_pd(half, _mm256_sub_pd(left, right)));
+    }
+    signed_areas_scalar(block, i, areas);
+}
+
+static bool avx2_supported() {
+    static const bool supported{__builtin_cpu_supports("avx2") != 0};
+    return supported;
+}
+#endif
+
+void Kernels::min_angle_cosines(const TriangleBlock& block, double* cosines) {
+#ifdef TRIMESH_AVX2_KERNELS
+    if(avx2_supported()) {
+        min_angle_cosines_avx2(block, cosines);
+        return;
+    }
+#endif
+    min_angle_cosines_scalar(block, 0, cosines);
+}
+
+void Kernels::signed_areas(const TriangleBlock& block, double* areas) {
+#ifdef TRIMESH_AVX2_KERNELS
+    if(avx2_supported()) {
+        signed_areas_avx2(block, areas);
+        return;
+    }
+#endif
+    signed_areas_scalar(block, 0, areas);
+}
+
+bool Kernels::vectorized() {
+#ifdef TRIMESH_AVX2_KERNELS
+    return avx2_supported();
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,54 @@
+#include <cstddef>
+#include <cmath>
+#include <limits>
+
+#include <Delaunay.hpp>
+
+#ifndef _KERNELS_HPP_
+#define _KERNELS_HPP_
+
+// Geometric kernels over blocks of triangles: AVX2 when the processor supports it (checked at runtime) and a scalar fallback.
+// Both paths evaluate the same operations in the same order, so results are identical.
+namespace Kernels {
+
+    // Block of triangles stored as structure of arrays: vertex coordinates of triangle i are
+    // (ax[i], ay[i]), (bx[i], by[i]) and (cx[i], cy[i])
+    struct TriangleBlock {
+        const double* ax;
+        const double* ay;
+        const double* bx;
+        const double* by;
+        const double* cx;
+        const double* cy;
+        size_t count;
+    };
+
+    // Cosine of the minimum angle of every triangle (the largest cosine of its angles, no acos)
+    void min_angle_cosines(const TriangleBlock& block, double* cosines);
+
+    // Signed area of every triangle (positive if counter-clockwise)
+    void signed_areas(const TriangleBlock& block, double* areas);
+
+    // Single triangle versions (same results as the batched ones)
+    double min_angle_cosine(const Coord2D& a, const Coord2D& b, const Coord2D& c);
+    double signed_area(const Coord2D& a, const Coord2D& b, const Coord2D& c);
+
+    // Single circle test (inline, used by every cavity search): the sign is certain if it exceeds the rounding
+    // of the squares and the error of the center
+    inline int in_circle(const Circumcircle& circle, const Coord2D& p) {
+        double dx{p.x - circle.x}, dy{p.y - circle.y};
+        double d2{dx*dx + dy*dy};
+        double difference{d2 - circle.r2};
+        double sum{d2 + circle.r2};
+        if(std::abs(difference) > 8 * std::numeric_limits<double>::epsilon() * sum && difference*difference > circle.error * sum) {
+            return (difference < 0) ? 1 : -1;
+        }
+        return 0;
+    }
+
+    // True if the AVX2 kernels are used
+    bool vectorized();
+
+}
+
+#endif //_KERNELS_HPP_
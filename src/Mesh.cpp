@@ -1,8 +1,14 @@
 #include <vector>
+#include <algorithm>
+#include <limits>
+#include <thread>
+#include <unordered_map>
+#include <chrono>
 #include <math.h>
 
 #include <Mesh.hpp>
 #include <Delaunay.hpp>
+#include <Stats.hpp>
 
 // Boundary constructors
 Boundary::Boundary(std::vector<Node> nodes, std::vector<Edge> edges) 
@@ -124,69 +130,334 @@ Boundary Boundary::naca(std::string code, double chord) {
         upper.emplace_back(xu(xc), yu(xc));
         lower.emplace_back(xl(xc), yl(xc));
     }
-    
-    return Boundary::combine(Boundary{upper, false}, Boundary{lower, false});
-}
 
-// Enable combination of unlimited number of boundaries
-template<typename T, typename... Args>
-Boundary Boundary::combine(T base, Args... boundaries) {
-    for(const Boundary& boundary : {boundaries...}) {
-        base = Boundary::combine(base, boundary);
-    }
-    return base;
+    // Close the (finite thickness) trailing edge
+    Boundary airfoil{Boundary::combine(Boundary{upper, false}, Boundary{lower, false})};
+    std::vector<Edge> edges{airfoil.get_edges()};
+    edges.emplace_back(upper.back(), lower.back());
+    return Boundary{airfoil.get_nodes(), edges};
 }
 
 // Static function to combine to boundary objects into one
 Boundary Boundary::combine(Boundary b1, Boundary b2) {
-    std::vector<Node> nodes = b1.get_nodes();
-    int i = nodes.size();
-    bool repeated;
-    for(Node& n2: b2.get_nodes()) {
-        repeated = false;
-        for(Node& n1: b1.get_nodes()) {
-            if(n2 == n1) {
-                repeated = true;
-                break;
+    return Boundary::combine(std::vector<Boundary>{b1, b2});
+}
+
+// Cell of the eps grid containing a point: nodes equal within eps lie in neighboring cells
+struct Cell {
+    long long x;
+    long long y;
+    bool operator==(const Cell& other) const {
+        return x == other.x && y == other.y;
+    }
+};
+
+struct CellHash {
+    size_t operator()(const Cell& cell) const {
+        return std::hash<long long>{}(cell.x * 73856093LL ^ cell.y * 19349663LL);
+    }
+};
+
+// Combine boundaries in a single pass. The result is the same as combining them one by one:
+// nodes of every boundary are compared with the nodes of the previous ones (not among themselves),
+// new nodes are renumbered after the existing ones and a closing edge is added for every boundary
+Boundary Boundary::combine(const std::vector<Boundary>& boundaries) {
+    if(boundaries.empty()) {
+        return Boundary{std::vector<Node>{}, std::vector<Edge>{}};
+    }
+    TRIMESH_STATS(std::chrono::steady_clock::time_point start{std::chrono::steady_clock::now()};)
+    size_t node_count{0}, edge_count{0};
+    for(const Boundary& boundary: boundaries) {
+        node_count += boundary.nodes.size();
+        edge_count += boundary.edges.size() + 1;
+    }
+    std::vector<Node> nodes;
+    std::vector<Edge> edges;
+    nodes.reserve(node_count);
+    edges.reserve(edge_count);
+
+    // Nodes of the previous boundaries hashed by eps grid cell. Non finite coordinates, or too large to give a
+    // long long cell, are kept apart and compared pairwise.
+    std::unordered_multimap<Cell, int, CellHash> grid;
+    grid.reserve(node_count);
+    std::vector<int> outliers;
+    auto hashable = [](const Coord2D& p) {
+        const double limit{1e18};
+        return std::abs(p.x / eps) < limit && std::abs(p.y / eps) < limit;
+    };
+    auto cell = [](const Coord2D& p) {
+        return Cell{static_cast<long long>(std::floor(p.x / eps)), static_cast<long long>(std::floor(p.y / eps))};
+    };
+    auto repeated = [&](const Node& node) {
+        if(!hashable(node.get_coords())) {
+            return std::find(nodes.begin(), nodes.begin() + grid.size() + outliers.size(), node)
+                   != nodes.begin() + grid.size() + outliers.size();
+        }
+        for(int i: outliers) {
+            if(nodes[i] == node) {
+                return true;
+            }
+        }
+        Cell center{cell(node.get_coords())};
+        for(long long dx{-1}; dx <= 1; dx++) {
+            for(long long dy{-1}; dy <= 1; dy++) {
+                auto range = grid.equal_range(Cell{center.x + dx, center.y + dy});
+                for(auto match = range.first; match != range.second; match++) {
+                    if(nodes[match->second] == node) {
+                        return true;
+                    }
+                }
+            }
+        }
+        return false;
+    };
+
+    nodes = boundaries[0].nodes;
+    edges = boundaries[0].edges;
+    for(size_t b{1}; b < boundaries.size(); b++) {
+        // Hash the nodes added by the previous boundary
+        size_t hashed{grid.size() + outliers.size()};
+        for(size_t i{hashed}; i < nodes.size(); i++) {
+            if(hashable(nodes[i].get_coords())) {
+                grid.emplace(cell(nodes[i].get_coords()), i);
+            } else {
+                outliers.push_back(i);
             }
         }
-        if (!repeated) {
-            n2.set_index(i++);
-            nodes.push_back(n2);
+        int i = nodes.size();
+        for(Node node: boundaries[b].nodes) {
+            if(!repeated(node)) {
+                node.set_index(i++);
+                nodes.push_back(node);
+            }
         }
+        edges.insert(edges.end(), boundaries[b].edges.begin(), boundaries[b].edges.end());
+        edges.push_back(Edge{nodes.back(), nodes.back()});
     }
-    std::vector<Edge> edges = b1.get_edges();
-    std::vector<Edge> edges2 = b2.get_edges();
-    edges.insert(edges.end(), edges2.begin(), edges2.end());
-    edges.push_back(Edge{nodes.back(), nodes.back()});
-    return Boundary{nodes, edges};
+    Boundary combined{nodes, edges};
+    TRIMESH_STATS(
+        // Combinations the input boundaries come from are included
+        combined.combine_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        for(const Boundary& boundary: boundaries) {
+            combined.combine_ms += boundary.combine_ms;
+        }
+    )
+    return combined;
+}
+
+
+// Background grid spacing: shortest segment, limited to about a million grid nodes
+BoundarySizeField::BoundarySizeField(Boundary boundary, double h_max, double gradation) {
+    std::vector<Edge> edges{boundary.get_edges()};
+    double min_x{std::numeric_limits<double>::infinity()}, max_x{-min_x};
+    double min_y{min_x}, max_y{-min_x};
+    double min_length{std::numeric_limits<double>::infinity()};
+    for(Edge& edge: edges) {
+        for(const Node& vertex: edge.get_vertices()) {
+            min_x = std::min(min_x, vertex.get_x());
+            max_x = std::max(max_x, vertex.get_x());
+            min_y = std::min(min_y, vertex.get_y());
+            max_y = std::max(max_y, vertex.get_y());
+        }
+        double length{edge.length()};
+        if(length > 0) {
+            min_length = std::min(min_length, length);
+        }
+    }
+    if(!std::isfinite(min_length)) {
+        // No segments: uniform size
+        x0 = y0 = 0;
+        cell = 1;
+        nx = ny = 1;
+        sizes.assign(1, h_max);
+        return;
+    }
+    double width{max_x - min_x}, height{max_y - min_y};
+    cell = std::max(min_length, std::sqrt(width * height / 1e6));
+    x0 = min_x;
+    y0 = min_y;
+    nx = static_cast<int>(std::ceil(width / cell)) + 1;
+    ny = static_cast<int>(std::ceil(height / cell)) + 1;
+    sizes.assign(static_cast<size_t>(nx) * ny, h_max);
+
+    // Grid nodes closest to the segments take their length
+    for(Edge& edge: edges) {
+        double length{edge.length()};
+        if(length == 0) {
+            continue;
+        }
+        std::array<Node, 2> vertices{edge.get_vertices()};
+        Coord2D a{vertices[0].get_coords()}, b{vertices[1].get_coords()};
+        int samples{static_cast<int>(std::ceil(length / cell))};
+        for(int s{0}; s <= samples; s++) {
+            double w{static_cast<double>(s) / samples};
+            int i{static_cast<int>(std::lround((a.x + w * (b.x - a.x) - x0) / cell))};
+            int j{static_cast<int>(std::lround((a.y + w * (b.y - a.y) - y0) / cell))};
+            double& size{sizes[static_cast<size_t>(j) * nx + i]};
+            size = std::min(size, length);
+        }
+    }
+
+    // Sizes grow by gradation times the distance: forward and backward chamfer passes
+    double straight{gradation * cell}, diagonal{gradation * cell * std::sqrt(2.0)};
+    auto relax = [&](int i, int j, int di, int dj, double step) {
+        int k{i + di}, l{j + dj};
+        if(k >= 0 && k < nx && l >= 0 && l < ny) {
+            double& size{sizes[static_cast<size_t>(j) * nx + i]};
+            size = std::min(size, sizes[static_cast<size_t>(l) * nx + k] + step);
+        }
+    };
+    for(int j{0}; j < ny; j++) {
+        for(int i{0}; i < nx; i++) {
+            relax(i, j, -1, 0, straight);
+            relax(i, j, 0, -1, straight);
+            relax(i, j, -1, -1, diagonal);
+            relax(i, j, 1, -1, diagonal);
+        }
+    }
+    for(int j{ny - 1}; j >= 0; j--) {
+        for(int i{nx - 1}; i >= 0; i--) {
+            relax(i, j, 1, 0, straight);
+            relax(i, j, 0, 1, straight);
+            relax(i, j, 1, 1, diagonal);
+            relax(i, j, -1, 1, diagonal);
+        }
+    }
+}
+
+// Bilinear interpolation of the grid (points outside the grid take the closest grid values)
+double BoundarySizeField::operator()(const Coord2D& p) const {
+    double u{std::clamp((p.x - x0) / cell, 0.0, static_cast<double>(nx - 1))};
+    double v{std::clamp((p.y - y0) / cell, 0.0, static_cast<double>(ny - 1))};
+    int i{std::min(static_cast<int>(u), std::max(nx - 2, 0))};
+    int j{std::min(static_cast<int>(v), std::max(ny - 2, 0))};
+    int i1{std::min(i + 1, nx - 1)}, j1{std::min(j + 1, ny - 1)};
+    double fu{u - i}, fv{v - j};
+    auto at = [this](int i, int j) {
+        return sizes[static_cast<size_t>(j) * nx + i];
+    };
+    return (1 - fv) * ((1 - fu) * at(i, j) + fu * at(i1, j)) + fv * ((1 - fu) * at(i, j1) + fu * at(i1, j1));
 }
 
 
 // Mesh constructor
-Mesh::Mesh(Boundary boundary, double h) {
+Mesh::Mesh(Boundary boundary, double h) : Mesh(boundary, [h](const Coord2D&) { return h; }) {
+}
+
+// Element size given by a size field (see BoundarySizeField for one derived from the boundary)
+Mesh::Mesh(Boundary boundary, const SizeField& size) {
+    TRIMESH_STATS(stats.combine_ms = boundary.combine_ms;)
     segments = boundary.get_edges();
+    build_index();
     std::vector<Coord2D> points;
     for(Node& node: boundary.get_nodes()) {
         points.push_back(node.get_coords());
     }
-    triangulation = Delaunay{points};
+    // Boundary segments are recovered and triangles outside the domain are not refined
+    triangulation = Delaunay{points, segments};
     triangulation.compute();
-    triangulation.refine(30 * M_PI / 180, h);
+    triangulation.refine(30 * M_PI / 180, size);
+}
+
+// Build the bucket index of the segments: as many buckets as segments over the boundary height
+void Mesh::build_index() {
+    segment_ends.clear();
+    segment_ends.reserve(segments.size());
+    double min_y{std::numeric_limits<double>::infinity()};
+    double max_y{-std::numeric_limits<double>::infinity()};
+    for(const Edge& edge: segments) {
+        std::array<Node, 2> vertices{edge.get_vertices()};
+        segment_ends.push_back({vertices[0].get_coords(), vertices[1].get_coords()});
+        for(const Node& vertex: vertices) {
+            min_y = std::min(min_y, vertex.get_y());
+            max_y = std::max(max_y, vertex.get_y());
+        }
+    }
+    int count{std::max(1, static_cast<int>(segments.size()))};
+    bucket_y0 = segments.empty() ? 0 : min_y;
+    bucket_height = (segments.empty() || max_y == min_y) ? 1 : (max_y - min_y) / count;
+
+    // Count segments per bucket, then fill them (compressed rows)
+    bucket_start.assign(count + 1, 0);
+    auto range = [this](const std::array<Coord2D, 2>& ends) {
+        return std::make_pair(bucket(std::min(ends[0].y, ends[1].y)), bucket(std::max(ends[0].y, ends[1].y)));
+    };
+    for(const std::array<Coord2D, 2>& ends: segment_ends) {
+        auto [first, last] = range(ends);
+        for(int b{first}; b <= last; b++) {
+            bucket_start[b + 1]++;
+        }
+    }
+    for(int b{0}; b < count; b++) {
+        bucket_start[b + 1] += bucket_start[b];
+    }
+    bucket_segments.resize(bucket_start.back());
+    std::vector<int> filled(bucket_start.begin(), bucket_start.end() - 1);
+    for(size_t s{0}; s < segment_ends.size(); s++) {
+        auto [first, last] = range(segment_ends[s]);
+        for(int b{first}; b <= last; b++) {
+            bucket_segments[filled[b]++] = s;
+        }
+    }
+}
+
+// Bucket of a y coordinate (clamped to the boundary height)
+int Mesh::bucket(double y) const {
+    int count{static_cast<int>(bucket_start.size()) - 1};
+    double position{std::floor((y - bucket_y0) / bucket_height)};
+    return static_cast<int>(std::clamp(position, 0.0, static_cast<double>(count - 1)));
 }
 
 // Check if point is inside the domain (based on given boundaries)
 bool Mesh::inside_domain(Coord2D p) {
+    return ray_cast(p);
+}
+
+// Classify a list of points, split in chunks across threads
+std::vector<bool> Mesh::inside_domain(const std::vector<Coord2D>& points, int threads) {
+    if(threads <= 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    int n{static_cast<int>(points.size())};
+    threads = std::max(1, std::min(threads, n / 1024));
+
+    std::vector<char> inside(n, 0);
+    auto classify = [&](int chunk) {
+        int begin{static_cast<int>(static_cast<long long>(n) * chunk / threads)};
+        int end{static_cast<int>(static_cast<long long>(n) * (chunk+1) / threads)};
+        for(int i{begin}; i < end; i++) {
+            inside[i] = ray_cast(points[i]);
+        }
+    };
+    if(threads == 1) {
+        classify(0);
+    } else {
+        std::vector<std::thread> workers;
+        for(int chunk{0}; chunk < threads; chunk++) {
+            workers.emplace_back(classify, chunk);
+        }
+        for(std::thread& worker: workers) {
+            worker.join();
+        }
+    }
+    return std::vector<bool>(inside.begin(), inside.end());
+}
+
+// Ray casting over the segments of the bucket of the point
+bool Mesh::ray_cast(const Coord2D& p) const {
     // Instantiate variables
-    std::vector<Node> intersecting_nodes;
     double m, n, x;
     int i{0};
+    if(segment_ends.empty()) {
+        return false;
+    }
 
-    // Loop over all boundary edges (segments)
-    for(Edge edge: segments) {
+    // Loop over the boundary edges (segments) whose y range may contain the point
+    int b{bucket(p.y)};
+    for(int s{bucket_start[b]}; s < bucket_start[b + 1]; s++) {
         // Get edge vertices
-        Coord2D p1 = edge.get_vertices().at(0).get_coords();
-        Coord2D p2 = edge.get_vertices().at(1).get_coords();
+        const Coord2D& p1 = segment_ends[bucket_segments[s]][0];
+        const Coord2D& p2 = segment_ends[bucket_segments[s]][1];
 
         // Check if one point y coordinate is greater and another lower (point in between w.r.t y coordinate)
         // This ensures that an horizontal line containing the point intersects the relevant boundary edge
@@ -214,34 +485,31 @@ bool Mesh::inside_domain(Coord2D p) {
     return (i % 4) == 2; // in fact we want to check that (i/2) % 2 == 1 due to that "double counting" approach
 }
 
-// Mesh getters
-Delaunay Mesh::get_triangulation() {
-    // Instantiate triangles and nodes
-    std::vector<Triangle> triangles;
-    std::vector<Node> nodes;
+// Stats of the triangulation and of the mesh phases
+Stats Mesh::get_stats() const {
+    Stats result{triangulation.get_stats()};
+    result += stats;
+    return result;
+}
 
-    // Loop over triangulation triangules
-    for(Triangle& triangle: triangulation.get_triangles()) {
-        // Add triangle if centroid is inside the domain
-        if(inside_domain(triangle.centroid())) {
-            triangles.push_back(triangle);
-        }
+// Smoothing of the interior nodes (boundary nodes lie on constrained edges and stay fixed). An extracted
+// domain is rebuilt in place, so references returned by get_triangulation stay valid.
+std::vector<SmoothingStep> Mesh::smooth(int iterations, Smoother smoother, bool flips, int threads) {
+    std::vector<SmoothingStep> steps{triangulation.smooth(iterations, smoother, flips, threads)};
+    if(domain) {
+        TRIMESH_TIMER(stats.get_triangulation_ms);
+        domain.emplace(triangulation.extract_domain());
     }
+    return steps;
+}
 
-    // Loop over triangulation nodes
-    for(Node& node: triangulation.get_nodes()) {
-        for(Edge edge: segments) {
-            // Add node if it belongs to the boundary
-            if(node == edge.get_vertices().at(0) || node == edge.get_vertices().at(1)) {
-                nodes.push_back(node);
-                break;
-            } else if(inside_domain(node.get_coords())) { // or is inside the domain
-                nodes.push_back(node);
-                break;
-            }
-        }
+// Mesh getters
+// Triangles outside the domain are already classified by the flood fill of the constrained
+// triangulation: the domain is extracted (unused nodes dropped and the rest renumbered) only once
+const Delaunay& Mesh::get_triangulation() {
+    if(!domain) {
+        TRIMESH_TIMER(stats.get_triangulation_ms);
+        domain = triangulation.extract_domain();
     }
-
-    // Re-built triangulation object
-    return Delaunay{triangles, nodes};
-}
\ No newline at end of file
+    return *domain;
+}
@@ -1,4 +1,6 @@
 #include <vector>
+#include <array>
+#include <optional>
 
 #include <Delaunay.hpp>
 
@@ -8,6 +10,9 @@
 class Boundary {
     std::vector<Edge> edges;
     std::vector<Node> nodes;
+    // Time spent combining the boundaries this one is made of (TRIMESH_ENABLE_STATS)
+    double combine_ms{0};
+    friend class Mesh;
 public:
     Boundary(std::vector<Node>, std::vector<Edge>);
     Boundary(std::vector<Node>, bool closed=true);
@@ -17,17 +22,57 @@ public:
     static Boundary circle(Coord2D p0, double r, double h);
     static Boundary naca(std::string code, double chord);
     static Boundary combine(Boundary b1, Boundary b2);
+    static Boundary combine(const std::vector<Boundary>& boundaries);
     template<typename T, typename... Args>
     static Boundary combine(T value, Args... args);
 };
 
+// Enable combination of unlimited number of boundaries
+template<typename T, typename... Args>
+Boundary Boundary::combine(T base, Args... boundaries) {
+    return Boundary::combine(std::vector<Boundary>{base, boundaries...});
+}
+
+// Size field derived from the boundary: the length of the boundary segments next to them, growing
+// with the distance to the boundary (gradation) up to h_max. Sampled on a background grid.
+class BoundarySizeField {
+    double x0;
+    double y0;
+    double cell;
+    int nx;
+    int ny;
+    std::vector<double> sizes;
+public:
+    BoundarySizeField(Boundary boundary, double h_max, double gradation=0.2);
+    double operator()(const Coord2D& p) const;
+};
+
 class Mesh {
     std::vector<Edge> segments;
     Delaunay triangulation;
+    // Mesh phases (boundary combination and domain extraction), see get_stats
+    Stats stats{};
+    // Triangulation of the domain (built on first request)
+    std::optional<Delaunay> domain;
+    // Segment ends bucketed by their y range: a horizontal ray only meets the segments of its bucket
+    std::vector<std::array<Coord2D, 2>> segment_ends;
+    std::vector<int> bucket_start;
+    std::vector<int> bucket_segments;
+    double bucket_y0;
+    double bucket_height;
+    void build_index();
+    int bucket(double y) const;
+    bool ray_cast(const Coord2D& p) const;
 public:
     Mesh(Boundary boundary, double h);
+    Mesh(Boundary boundary, const SizeField& size);
     bool inside_domain(Coord2D p);
-    Delaunay get_triangulation();
+    std::vector<bool> inside_domain(const std::vector<Coord2D>& points, int threads=0);
+    std::vector<SmoothingStep> smooth(int iterations, Smoother smoother=Smoother::odt, bool flips=true, int threads=1);
+    // Triangulation of the domain, owned by the mesh: the reference stays valid for the lifetime of the mesh
+    // and shows the smoothed nodes after smooth
+    const Delaunay& get_triangulation();
+    Stats get_stats() const;
 };
 
 
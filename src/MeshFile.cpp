@@ -0,0 +1,142 @@
+#include <vector>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+#include <climits>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <MeshFile.hpp>
+#include <Delaunay.hpp>
+
+// Map the file and check its header and sections
+MeshView::MeshView(const std::string& filename)
+    : file{std::make_unique<boost::iostreams::mapped_file_source>()}, filename{filename} {
+    try {
+        file->open(filename);
+    } catch(const std::exception& e) {
+        throw std::runtime_error("Cannot map " + filename + ": " + e.what());
+    }
+    if(file->size() < sizeof(MeshFile::Header)) {
+        throw std::runtime_error("Invalid mesh file " + filename);
+    }
+    std::memcpy(&header, file->data(), sizeof(header));
+    if(std::memcmp(header.magic, MeshFile::magic, sizeof(header.magic)) != 0) {
+        throw std::runtime_error("Invalid mesh file " + filename);
+    }
+    if(header.version > MeshFile::version) {
+        throw std::runtime_error("Unsupported mesh file version " + std::to_string(header.version));
+    }
+    if(header.byte_order != MeshFile::byte_order) {
+        throw std::runtime_error("Mesh file " + filename + " was written with a different byte order");
+    }
+
+    // Counts must fit the int indices of the triangulation
+    if(header.nodes > INT_MAX || header.triangles > INT_MAX || header.segments > INT_MAX) {
+        throw std::runtime_error("Corrupted mesh file " + filename);
+    }
+
+    // Sections must be aligned and lie inside the file
+    auto check = [&](uint64_t offset, uint64_t count, uint64_t size) {
+        if(offset % 8 != 0 || offset > file->size() || count > (file->size() - offset) / size) {
+            throw std::runtime_error("Corrupted mesh file " + filename);
+        }
+    };
+    check(header.x_offset, header.nodes, sizeof(double));
+    check(header.y_offset, header.nodes, sizeof(double));
+    check(header.triangles_offset, header.triangles, sizeof(std::array<int, 3>));
+    if(has_neighbors()) {
+        check(header.neighbors_offset, header.triangles, sizeof(std::array<int, 3>));
+    }
+    check(header.segments_offset, header.segments, sizeof(std::array<int, 2>));
+}
+
+MeshView::~MeshView() {
+}
+
+// Address of a section inside the mapped file
+const char* MeshView::section(uint64_t offset) const {
+    return file->data() + offset;
+}
+
+int MeshView::get_nodes_count() const {
+    return static_cast<int>(header.nodes);
+}
+
+int MeshView::get_triangles_count() const {
+    return static_cast<int>(header.triangles);
+}
+
+bool MeshView::has_neighbors() const {
+    return (header.flags & MeshFile::adjacency) != 0;
+}
+
+Coord2D MeshView::get_node(int v) const {
+    return Coord2D{get_x()[v], get_y()[v]};
+}
+
+View<double> MeshView::get_x() const {
+    return View<double>{reinterpret_cast<const double*>(section(header.x_offset)), header.nodes};
+}
+
+View<double> MeshView::get_y() const {
+    return View<double>{reinterpret_cast<const double*>(section(header.y_offset)), header.nodes};
+}
+
+View<std::array<int, 3>> MeshView::get_triangles_index() const {
+    return View<std::array<int, 3>>{reinterpret_cast<const std::array<int, 3>*>(section(header.triangles_offset)), header.triangles};
+}
+
+// Adjacency of the triangles (empty if the file was saved without it)
+View<std::array<int, 3>> MeshView::get_neighbors_index() const {
+    if(!has_neighbors()) {
+        return View<std::array<int, 3>>{};
+    }
+    return View<std::array<int, 3>>{reinterpret_cast<const std::array<int, 3>*>(section(header.neighbors_offset)), header.triangles};
+}
+
+View<std::array<int, 2>> MeshView::get_segments_index() const {
+    return View<std::array<int, 2>>{reinterpret_cast<const std::array<int, 2>*>(section(header.segments_offset)), header.segments};
+}
+
+// Copy into a triangulation that can be modified (adjacency is rebuilt if missing). Indices are checked
+// here and not when mapping, so that the views stay free of any pass over the data.
+Delaunay MeshView::to_delaunay() const {
+    int nodes{get_nodes_count()}, count{get_triangles_count()};
+    auto check = [&](bool valid) {
+        if(!valid) {
+            throw std::runtime_error("Corrupted mesh file " + filename);
+        }
+    };
+    for(const std::array<int, 3>& triangle: get_triangles_index()) {
+        for(int v: triangle) {
+            check(v >= -3 && v < nodes);
+        }
+    }
+    for(const std::array<int, 3>& neighbors: get_neighbors_index()) {
+        for(int t: neighbors) {
+            check(t >= -1 && t < count);
+        }
+    }
+    for(const std::array<int, 2>& segment: get_segments_index()) {
+        check(segment[0] >= 0 && segment[0] < nodes && segment[1] >= 0 && segment[1] < nodes);
+    }
+
+    Delaunay d{};
+    View<double> x{get_x()}, y{get_y()};
+    d.xs.insert(d.xs.end(), x.begin(), x.end());
+    d.ys.insert(d.ys.end(), y.begin(), y.end());
+    View<std::array<int, 3>> triangles{get_triangles_index()};
+    d.triangles.assign(triangles.begin(), triangles.end());
+    if(has_neighbors()) {
+        View<std::array<int, 3>> neighbors{get_neighbors_index()};
+        d.neighbors.assign(neighbors.begin(), neighbors.end());
+    } else {
+        d.build_neighbors();
+    }
+    d.update_circles();
+    for(const std::array<int, 2>& segment: get_segments_index()) {
+        d.constraints.insert(Delaunay::edge_key(segment[0], segment[1]));
+    }
+    return d;
+}
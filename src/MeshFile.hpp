@@ -0,0 +1,66 @@
+#include <vector>
+#include <array>
+#include <string>
+#include <memory>
+#include <cstdint>
+
+#include <Delaunay.hpp>
+
+#ifndef _MESHFILE_HPP_
+#define _MESHFILE_HPP_
+
+namespace boost { namespace iostreams { class mapped_file_source; } }
+
+// Binary mesh format (native byte order, sections aligned to 8 bytes):
+// header, node x coordinates, node y coordinates, triangles, adjacency (optional), segments
+namespace MeshFile {
+
+    const char magic[8]{'T', 'R', 'I', 'M', 'E', 'S', 'H', '\0'};
+    const uint32_t version{1};
+    const uint32_t byte_order{0x01020304};
+
+    // Flags
+    const uint32_t adjacency{1};
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t flags;
+        uint32_t byte_order;
+        uint32_t reserved;
+        uint64_t nodes;
+        uint64_t triangles;
+        uint64_t segments;
+        // Offsets of the sections from the beginning of the file (0 if missing)
+        uint64_t x_offset;
+        uint64_t y_offset;
+        uint64_t triangles_offset;
+        uint64_t neighbors_offset;
+        uint64_t segments_offset;
+    };
+
+}
+
+// Read-only mesh mapped from a binary mesh file: data is accessed in place (no copy or parsing)
+class MeshView {
+    std::unique_ptr<boost::iostreams::mapped_file_source> file;
+    std::string filename;
+    MeshFile::Header header;
+    const char* section(uint64_t offset) const;
+public:
+    MeshView(const std::string& filename);
+    ~MeshView();
+    int get_nodes_count() const;
+    int get_triangles_count() const;
+    bool has_neighbors() const;
+    Coord2D get_node(int v) const;
+    View<double> get_x() const;
+    View<double> get_y() const;
+    View<std::array<int, 3>> get_triangles_index() const;
+    View<std::array<int, 3>> get_neighbors_index() const;
+    View<std::array<int, 2>> get_segments_index() const;
+    Delaunay to_delaunay() const;
+};
+
+
+#endif //_MESHFILE_HPP_
@@ -0,0 +1,210 @@
+#include <vector>
+#include <cmath>
+
+#include <Predicates.hpp>
+#include <Stats.hpp>
+
+// Error bounds of the floating point filters (Shewchuk, 1997)
+static const double epsilon{std::ldexp(1.0, -53)};
+static const double ccw_error_bound{(3.0 + 16.0*epsilon) * epsilon};
+static const double incircle_error_bound{(10.0 + 96.0*epsilon) * epsilon};
+
+#ifdef TRIMESH_ENABLE_STATS
+// Counters of the calling thread (threads report their own counts, see PredicateScope in Delaunay.cpp)
+struct ThreadCounts {
+    long long orient2d{0};
+    long long incircle{0};
+    long long exact{0};
+    long long circle_tests{0};
+};
+static thread_local ThreadCounts thread_counts;
+#endif
+
+Predicates::Counts Predicates::counts() {
+#ifdef TRIMESH_ENABLE_STATS
+    return Counts{thread_counts.orient2d, thread_counts.incircle, thread_counts.exact, thread_counts.circle_tests};
+#else
+    return Counts{0, 0, 0, 0};
+#endif
+}
+
+void Predicates::count_circle_test() {
+    TRIMESH_STATS(thread_counts.circle_tests++;)
+}
+
+// Exact arithmetic on expansions: sums of non-overlapping doubles sorted by increasing magnitude
+using Expansion = std::vector<double>;
+
+// x + y = a + b exactly
+static void two_sum(double a, double b, double& x, double& y) {
+    x = a + b;
+    double b_virtual{x - a};
+    double a_virtual{x - b_virtual};
+    y = (a - a_virtual) + (b - b_virtual);
+}
+
+// x + y = a + b exactly, requires |a| >= |b|
+static void fast_two_sum(double a, double b, double& x, double& y) {
+    x = a + b;
+    y = b - (x - a);
+}
+
+// x + y = a * b exactly
+static void two_product(double a, double b, double& x, double& y) {
+    x = a * b;
+    y = std::fma(a, b, -x);
+}
+
+// Add a double to an expansion
+static Expansion grow(const Expansion& e, double b) {
+    Expansion h;
+    h.reserve(e.size() + 1);
+    double q{b}, hh;
+    for(double component: e) {
+        two_sum(q, component, q, hh);
+        if(hh != 0) {
+            h.push_back(hh);
+        }
+    }
+    if(q != 0 || h.empty()) {
+        h.push_back(q);
+    }
+    return h;
+}
+
+static Expansion sum(const Expansion& e, const Expansion& f) {
+    Expansion h{e};
+    for(double component: f) {
+        h = grow(h, component);
+    }
+    return h;
+}
+
+static Expansion negate(Expansion e) {
+    for(double& component: e) {
+        component = -component;
+    }
+    return e;
+}
+
+// Multiply an expansion by a double
+static Expansion scale(const Expansion& e, double b) {
+    Expansion h;
+    h.reserve(2*e.size());
+    double q, hh, product1, product0, sum_value;
+    two_product(e[0], b, q, hh);
+    if(hh != 0) {
+        h.push_back(hh);
+    }
+    for(size_t i{1}; i < e.size(); i++) {
+        two_product(e[i], b, product1, product0);
+        two_sum(q, product0, sum_value, hh);
+        if(hh != 0) {
+            h.push_back(hh);
+        }
+        fast_two_sum(product1, sum_value, q, hh);
+        if(hh != 0) {
+            h.push_back(hh);
+        }
+    }
+    if(q != 0 || h.empty()) {
+        h.push_back(q);
+    }
+    return h;
+}
+
+static Expansion product(const Expansion& e, const Expansion& f) {
+    Expansion h{0.0};
+    for(double component: f) {
+        h = sum(h, scale(e, component));
+    }
+    return h;
+}
+
+// a - b as an expansion of two components
+static Expansion difference(double a, double b) {
+    double x, y;
+    two_sum(a, -b, x, y);
+    return (y == 0) ? Expansion{x} : Expansion{y, x};
+}
+
+// Most significant component carries the sign of the expansion
+static double estimate(const Expansion& e) {
+    return e.back();
+}
+
+double Predicates::orient2d_exact(const Coord2D& a, const Coord2D& b, const Coord2D& c) {
+    // Sum of the six products of the expanded determinant
+    Expansion det{0.0};
+    std::array<std::array<double, 2>, 6> terms{{
+        {a.x, b.y}, {-a.y, b.x}, {b.x, c.y}, {-b.y, c.x}, {c.x, a.y}, {-c.y, a.x}
+    }};
+    double x, y;
+    for(const auto& term: terms) {
+        two_product(term[0], term[1], x, y);
+        det = grow(grow(det, y), x);
+    }
+    return estimate(det);
+}
+
+double Predicates::orient2d(const Coord2D& a, const Coord2D& b, const Coord2D& c) {
+    TRIMESH_STATS(thread_counts.orient2d++;)
+    double det_left{(a.x - c.x) * (b.y - c.y)};
+    double det_right{(a.y - c.y) * (b.x - c.x)};
+    double det{det_left - det_right};
+
+    // Filter: the rounding error cannot flip the sign
+    double det_sum{std::abs(det_left) + std::abs(det_right)};
+    if(std::abs(det) >= ccw_error_bound * det_sum) {
+        return det;
+    }
+    TRIMESH_STATS(thread_counts.exact++;)
+    return orient2d_exact(a, b, c);
+}
+
+double Predicates::incircle_exact(const Coord2D& a, const Coord2D& b, const Coord2D& c, const Coord2D& d) {
+    // Exact differences w.r.t. the query point
+    Expansion adx{difference(a.x, d.x)}, ady{difference(a.y, d.y)};
+    Expansion bdx{difference(b.x, d.x)}, bdy{difference(b.y, d.y)};
+    Expansion cdx{difference(c.x, d.x)}, cdy{difference(c.y, d.y)};
+
+    // Lifted coordinates (squared distances to the query point)
+    Expansion alift{sum(product(adx, adx), product(ady, ady))};
+    Expansion blift{sum(product(bdx, bdx), product(bdy, bdy))};
+    Expansion clift{sum(product(cdx, cdx), product(cdy, cdy))};
+
+    // Cofactors
+    Expansion bc{sum(product(bdx, cdy), negate(product(cdx, bdy)))};
+    Expansion ca{sum(product(cdx, ady), negate(product(adx, cdy)))};
+    Expansion ab{sum(product(adx, bdy), negate(product(bdx, ady)))};
+
+    Expansion det{sum(sum(product(alift, bc), product(blift, ca)), product(clift, ab))};
+    return estimate(det);
+}
+
+double Predicates::incircle(const Coord2D& a, const Coord2D& b, const Coord2D& c, const Coord2D& d) {
+    TRIMESH_STATS(thread_counts.incircle++;)
+    double adx{a.x - d.x}, ady{a.y - d.y};
+    double bdx{b.x - d.x}, bdy{b.y - d.y};
+    double cdx{c.x - d.x}, cdy{c.y - d.y};
+
+    double bdxcdy{bdx * cdy}, cdxbdy{cdx * bdy};
+    double cdxady{cdx * ady}, adxcdy{adx * cdy};
+    double adxbdy{adx * bdy}, bdxady{bdx * ady};
+
+    double alift{adx*adx + ady*ady};
+    double blift{bdx*bdx + bdy*bdy};
+    double clift{cdx*cdx + cdy*cdy};
+
+    double det{alift * (bdxcdy - cdxbdy) + blift * (cdxady - adxcdy) + clift * (adxbdy - bdxady)};
+
+    // Filter: the rounding error cannot flip the sign
+    double permanent{(std::abs(bdxcdy) + std::abs(cdxbdy)) * alift
+                   + (std::abs(cdxady) + std::abs(adxcdy)) * blift
+                   + (std::abs(adxbdy) + std::abs(bdxady)) * clift};
+    if(std::abs(det) > incircle_error_bound * permanent) {
+        return det;
+    }
+    TRIMESH_STATS(thread_counts.exact++;)
+    return incircle_exact(a, b, c, d);
+}
@@ -0,0 +1,35 @@
+#include <vector>
+
+#include <Delaunay.hpp>
+
+#ifndef _PREDICATES_HPP_
+#define _PREDICATES_HPP_
+
+// Geometric predicates with a floating point filter and an exact fallback (Shewchuk, 1997)
+namespace Predicates {
+
+    // Positive if a, b, c are in counter-clockwise order, negative if clockwise, zero if collinear
+    double orient2d(const Coord2D& a, const Coord2D& b, const Coord2D& c);
+
+    // Positive if d lies inside the circle through counter-clockwise a, b, c, negative if outside
+    double incircle(const Coord2D& a, const Coord2D& b, const Coord2D& c, const Coord2D& d);
+
+    // Exact evaluation, used when the filter cannot certify the sign
+    double orient2d_exact(const Coord2D& a, const Coord2D& b, const Coord2D& c);
+    double incircle_exact(const Coord2D& a, const Coord2D& b, const Coord2D& c, const Coord2D& d);
+
+    // Evaluations of orient2d and incircle, exact fallbacks and in-circle tests against cached circumcircles
+    // (counted by the caller) by the calling thread only: worker threads report their own counts (always zero
+    // unless built with TRIMESH_ENABLE_STATS)
+    struct Counts {
+        long long orient2d;
+        long long incircle;
+        long long exact;
+        long long circle_tests;
+    };
+    Counts counts();
+    void count_circle_test();
+
+}
+
+#endif //_PREDICATES_HPP_
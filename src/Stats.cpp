@@ -0,0 +1,58 @@
+#include <string>
+#include <sstream>
+#include <algorithm>
+
+#include <Stats.hpp>
+
+Stats& Stats::operator+=(const Stats& other) {
+    orient2d += other.orient2d;
+    incircle += other.incircle;
+    exact += other.exact;
+    circle_tests += other.circle_tests;
+    insertions += other.insertions;
+    cavity_triangles += other.cavity_triangles;
+    max_cavity = std::max(max_cavity, other.max_cavity);
+    walks += other.walks;
+    walk_steps += other.walk_steps;
+    max_walk = std::max(max_walk, other.max_walk);
+    triangles_created += other.triangles_created;
+    triangles_destroyed += other.triangles_destroyed;
+    parallel_fallbacks += other.parallel_fallbacks;
+    quality_points += other.quality_points;
+    size_points += other.size_points;
+    segment_splits += other.segment_splits;
+    rescans += other.rescans;
+    stale_items += other.stale_items;
+    requeued_items += other.requeued_items;
+    compute_ms += other.compute_ms;
+    refine_quality_ms += other.refine_quality_ms;
+    refine_size_ms += other.refine_size_ms;
+    get_triangulation_ms += other.get_triangulation_ms;
+    combine_ms += other.combine_ms;
+    return *this;
+}
+
+// Single line JSON object, averages are derived from the totals
+std::string Stats::json() const {
+    std::ostringstream out;
+    auto average = [](long long total, long long count) {
+        return count ? static_cast<double>(total) / count : 0.0;
+    };
+    out << "{\"enabled\": " << (enabled ? "true" : "false")
+        << ", \"predicates\": {\"orient2d\": " << orient2d << ", \"incircle\": " << incircle << ", \"exact\": " << exact
+        << ", \"circle_tests\": " << circle_tests << "}"
+        << ", \"insertions\": " << insertions
+        << ", \"cavity\": {\"triangles\": " << cavity_triangles << ", \"mean\": " << average(cavity_triangles, insertions)
+        << ", \"max\": " << max_cavity << "}"
+        << ", \"walks\": {\"count\": " << walks << ", \"steps\": " << walk_steps << ", \"mean\": " << average(walk_steps, walks)
+        << ", \"max\": " << max_walk << "}"
+        << ", \"triangles\": {\"created\": " << triangles_created << ", \"destroyed\": " << triangles_destroyed << "}"
+        << ", \"parallel_fallbacks\": " << parallel_fallbacks
+        << ", \"refinement\": {\"quality_points\": " << quality_points << ", \"size_points\": " << size_points
+        << ", \"segment_splits\": " << segment_splits << ", \"rescans\": " << rescans << ", \"stale_items\": " << stale_items
+        << ", \"requeued_items\": " << requeued_items << "}"
+        << ", \"time_ms\": {\"compute\": " << compute_ms << ", \"refine_quality\": " << refine_quality_ms
+        << ", \"refine_size\": " << refine_size_ms << ", \"get_triangulation\": " << get_triangulation_ms
+        << ", \"combine\": " << combine_ms << "}}";
+    return out.str();
+}
@@ -0,0 +1,72 @@
+#include <string>
+#include <chrono>
+
+#ifndef _STATS_HPP_
+#define _STATS_HPP_
+
+// Counting and timing statements, compiled only with TRIMESH_ENABLE_STATS (CMake option of the same name)
+#ifdef TRIMESH_ENABLE_STATS
+#define TRIMESH_STATS(...) __VA_ARGS__
+#define TRIMESH_TIMER(total) PhaseTimer phase_timer{total}
+#else
+#define TRIMESH_STATS(...)
+#define TRIMESH_TIMER(total)
+#endif
+
+// Performance counters and phase timers of the meshing algorithms (all zero unless enabled)
+struct Stats {
+    // Predicate evaluations, exact fallbacks (the filter could not certify the sign) and in-circle tests
+    // against cached circumcircles (the ones too close to the circle also evaluate incircle)
+    long long orient2d{0};
+    long long incircle{0};
+    long long exact{0};
+    long long circle_tests{0};
+    // Node insertions and the triangles they replaced (cavity, or split and flipped triangles)
+    long long insertions{0};
+    long long cavity_triangles{0};
+    long long max_cavity{0};
+    // Point location walks and triangles crossed
+    long long walks{0};
+    long long walk_steps{0};
+    long long max_walk{0};
+    long long triangles_created{0};
+    long long triangles_destroyed{0};
+    // Parallel constructions whose strips could not be merged (degenerate input) and ran serially instead
+    long long parallel_fallbacks{0};
+    // Refinement: Steiner points inserted by the quality and size rules, encroached segments split
+    long long quality_points{0};
+    long long size_points{0};
+    long long segment_splits{0};
+    // Refinement sweeps over all triangles, queued triangles removed before their turn and triangles queued
+    // again (rejected for encroachment or postponed by a conflicting cavity)
+    long long rescans{0};
+    long long stale_items{0};
+    long long requeued_items{0};
+    // Phase times in milliseconds
+    double compute_ms{0};
+    double refine_quality_ms{0};
+    double refine_size_ms{0};
+    double get_triangulation_ms{0};
+    double combine_ms{0};
+#ifdef TRIMESH_ENABLE_STATS
+    static constexpr bool enabled{true};
+#else
+    static constexpr bool enabled{false};
+#endif
+    Stats& operator+=(const Stats& other);
+    std::string json() const;
+};
+
+// Adds the time until the end of the scope to a phase total (milliseconds)
+class PhaseTimer {
+    double& total;
+    std::chrono::steady_clock::time_point start;
+public:
+    PhaseTimer(double& total) : total{total}, start{std::chrono::steady_clock::now()} {}
+    ~PhaseTimer() {
+        total += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+
+#endif //_STATS_HPP_
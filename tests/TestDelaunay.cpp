@@ -1,6 +1,58 @@
 #include <gtest/gtest.h>
 #include <Delaunay.hpp>
 
+#include <random>
+#include <cmath>
+#include <thread>
+
+// Nodes on the unit circle (circumcenters of skinny hull triangles do not escape) and random ones inside it
+static std::vector<Coord2D> circle_with_points(unsigned seed) {
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<double> dis(-0.5, 0.5);
+  std::vector<Coord2D> points;
+  for(int i{0}; i < 40; i++) {
+    points.push_back(Coord2D{cos(i*M_PI/20), sin(i*M_PI/20)});
+  }
+  for(int i{0}; i < 20; i++) {
+    points.push_back(Coord2D{dis(gen), dis(gen)});
+  }
+  return points;
+}
+
+// Square domain [0, 4]^2 with a square hole [1.5, 2.5]^2 (corners and sides as segments)
+struct Domain {
+  std::vector<Coord2D> points;
+  std::vector<Edge> segments;
+};
+
+static Domain square_with_hole() {
+  std::vector<Coord2D> corners{{0, 0}, {4, 0}, {4, 4}, {0, 4}};
+  std::vector<Coord2D> hole{{1.5, 1.5}, {2.5, 1.5}, {2.5, 2.5}, {1.5, 2.5}};
+  Domain domain{corners, {}};
+  domain.points.insert(domain.points.end(), hole.begin(), hole.end());
+  for(int i{0}; i < 4; i++) {
+    domain.segments.emplace_back(Node{corners[i]}, Node{corners[(i+1)%4]});
+    domain.segments.emplace_back(Node{hole[i]}, Node{hole[(i+1)%4]});
+  }
+  return domain;
+}
+
+// Triangles of the square domain only (none in the hole) covering the given area, constraints are edges
+static void expect_constrained_domain(const Delaunay& d, double area) {
+  double total{0};
+  for(Triangle& t: d.get_triangles()) {
+    Coord2D c{t.centroid()};
+    ASSERT_TRUE(c.x > 0 && c.x < 4 && c.y > 0 && c.y < 4);
+    ASSERT_FALSE(c.x > 1.5 && c.x < 2.5 && c.y > 1.5 && c.y < 2.5);
+    total += t.get_area();
+  }
+  ASSERT_NEAR(total, area, 1e-9);
+  std::vector<std::array<int, 2>> edges{d.get_edges_index()};
+  for(const std::array<int, 2>& constraint: d.get_constraints_index()) {
+    ASSERT_TRUE(std::binary_search(edges.begin(), edges.end(), constraint));
+  }
+}
+
 // Delaunay test
 TEST(DelaunayTest, GeometryUtils) {
   Coord2D p1{-1, 3};
@@ -185,4 +237,515 @@ TEST(DelaunayTest, NeighborTest) {
   };
 
   ASSERT_EQ(calc_neighbors, true_neighbors);
-}
\ No newline at end of file
+}
+
+TEST(DelaunayTest, NeighborIndexTest) {
+  std::vector<double> x{-1.01, -1.01, 1.01, 3.04, 5.05, 8.21, 8.22};
+  std::vector<double> y{0, 5, 2.01, 3.02, 2.003, 0, 5.03};
+
+  std::vector<Coord2D> points;
+
+	for(size_t i{0}; i<x.size(); i++) {
+		points.push_back(Coord2D{x[i], y[i]});
+	}
+
+  Delaunay d{points};
+
+  d.compute();
+  d.add_point(4, 1);
+  d.add_point(2, 4);
+
+  std::vector<std::array<int, 3>> tris{d.get_triangles_index()};
+  std::vector<std::array<int, 3>> neighbors{d.get_neighbors_index()};
+
+  ASSERT_EQ(tris.size(), neighbors.size());
+
+  // Every neighbor shares the edge opposite to the vertex and points back
+  for(size_t t{0}; t < tris.size(); t++) {
+    for(int k{0}; k < 3; k++) {
+      int n{neighbors[t][k]};
+      if(n == -1) {
+        continue;
+      }
+      std::array<int, 3> other{tris[n]};
+      int a{tris[t][(k+1)%3]};
+      int b{tris[t][(k+2)%3]};
+      ASSERT_NE(std::find(other.begin(), other.end(), a), other.end());
+      ASSERT_NE(std::find(other.begin(), other.end(), b), other.end());
+      ASSERT_NE(std::find(neighbors[n].begin(), neighbors[n].end(), static_cast<int>(t)), neighbors[n].end());
+    }
+  }
+}
+
+
+TEST(DelaunayTest, SpatialOrderTest) {
+  std::mt19937 gen(0);
+  std::uniform_real_distribution<double> dis(-10.0, 10.0);
+
+  std::vector<Coord2D> points;
+  for(int i{0}; i < 500; i++) {
+    points.push_back(Coord2D{dis(gen), dis(gen)});
+  }
+
+  // Insertion order is a permutation of the points
+  std::vector<int> order{spatial_order(points)};
+  std::vector<int> sorted_order{order};
+  std::sort(sorted_order.begin(), sorted_order.end());
+  for(int i{0}; i < 500; i++) {
+    ASSERT_EQ(i, sorted_order[i]);
+  }
+
+  // Triangulation does not depend on insertion order
+  Delaunay d1{points};
+  Delaunay d2{points};
+  d1.compute();
+  d2.compute(false);
+
+  ASSERT_EQ(d2.get_triangles_index(), d1.get_triangles_index());
+}
+
+
+TEST(DelaunayTest, ParallelTest) {
+  std::mt19937 gen(1);
+  std::uniform_real_distribution<double> dis(0.0, 1.0);
+
+  std::vector<Coord2D> points;
+  for(int i{0}; i < 5000; i++) {
+    points.push_back(Coord2D{dis(gen), dis(gen)});
+  }
+
+  Delaunay serial{points};
+  Delaunay parallel{points};
+  serial.compute();
+  parallel.compute_parallel(4);
+
+  ASSERT_EQ(serial.get_triangles_index(), parallel.get_triangles_index());
+  ASSERT_EQ(serial.get_neighbors_index(), parallel.get_neighbors_index());
+  // Strips were merged (fallbacks are only counted with TRIMESH_ENABLE_STATS)
+  ASSERT_EQ(parallel.get_stats().parallel_fallbacks, 0);
+
+  // Duplicated nodes break the merge: same result from the serial algorithm
+  std::vector<Coord2D> duplicated{points};
+  duplicated.insert(duplicated.end(), points.begin(), points.begin() + 100);
+  Delaunay serial_duplicated{duplicated};
+  Delaunay parallel_duplicated{duplicated};
+  serial_duplicated.compute();
+  parallel_duplicated.compute_parallel(4);
+  ASSERT_EQ(serial_duplicated.get_triangles_index(), parallel_duplicated.get_triangles_index());
+  if(Stats::enabled) {
+    ASSERT_EQ(parallel_duplicated.get_stats().parallel_fallbacks, 1);
+  }
+}
+
+
+TEST(DelaunayTest, RefineTest) {
+  std::vector<Coord2D> points{circle_with_points(2)};
+
+  double alpha{25 * M_PI / 180};
+
+  // Quality refinement only
+  Delaunay d1{points};
+  d1.compute();
+  ASSERT_GT(d1.get_bad_triangles(alpha).size(), 0);
+  d1.refine(alpha, 10);
+  ASSERT_EQ(0, d1.get_bad_triangles(alpha).size());
+  ASSERT_GT(d1.get_nodes().size(), points.size());
+
+  // Quality and size refinement
+  Delaunay d2{points};
+  d2.compute();
+  d2.refine(alpha, 0.1);
+  ASSERT_EQ(0, d2.get_big_triangles(0.1).size());
+  ASSERT_GT(d2.get_nodes().size(), d1.get_nodes().size());
+}
+
+
+TEST(DelaunayTest, RebuildTest) {
+  std::vector<double> x{-1.01, -1.01, 1.01, 3.04, 5.05, 8.21, 8.22};
+  std::vector<double> y{0, 5, 2.01, 3.02, 2.003, 0, 5.03};
+
+  std::vector<Coord2D> points;
+
+	for(size_t i{0}; i<x.size(); i++) {
+		points.push_back(Coord2D{x[i], y[i]});
+	}
+
+  Delaunay d{points};
+
+  d.compute();
+
+  // Keep triangles {1, 3, 6} and {3, 4, 6}: nodes are renumbered following the list
+  std::vector<Triangle> triangles{d.get_triangles().at(4), d.get_triangles().at(6)};
+  std::vector<Node> nodes{d.get_nodes().at(6), d.get_nodes().at(1), d.get_nodes().at(3), d.get_nodes().at(4)};
+
+  Delaunay r{triangles, nodes};
+
+  std::vector<std::array<int, 3>> true_tris{{0, 1, 2}, {0, 2, 3}};
+  ASSERT_EQ(true_tris, r.get_triangles_index());
+  ASSERT_EQ(4, r.get_nodes_count());
+  ASSERT_EQ(nodes.at(0), r.get_nodes().at(0));
+  ASSERT_EQ(nodes.at(3), r.get_nodes().at(3));
+
+  std::vector<std::array<int, 3>> true_neighbors{{-1, 1, -1}, {-1, -1, 0}};
+  ASSERT_EQ(true_neighbors, r.get_neighbors_index());
+}
+
+
+TEST(DelaunayTest, CircumcircleTest) {
+  std::vector<double> x{-1.01, -1.01, 1.01, 3.04, 5.05, 8.21, 8.22};
+  std::vector<double> y{0, 5, 2.01, 3.02, 2.003, 0, 5.03};
+
+  std::vector<Coord2D> points;
+
+	for(size_t i{0}; i<x.size(); i++) {
+		points.push_back(Coord2D{x[i], y[i]});
+	}
+
+  Delaunay d{points};
+
+  d.compute();
+  d.add_point(4, 1);
+
+  std::vector<Triangle> triangles{d.get_triangles()};
+  std::vector<Coord2D> centers{d.get_circumcenters()};
+  std::vector<double> radii{d.get_circumradii()};
+
+  ASSERT_EQ(triangles.size(), centers.size());
+  ASSERT_EQ(triangles.size(), radii.size());
+  for(size_t t{0}; t < triangles.size(); t++) {
+    ASSERT_EQ(triangles[t].circumcenter(), centers[t]);
+    ASSERT_NEAR(dist(centers[t], triangles[t][0].get_coords()), radii[t], 1e-12);
+  }
+}
+
+
+TEST(DelaunayTest, ConstrainedTest) {
+  // Square domain with a square hole and a segment inside the domain
+  std::vector<Coord2D> points;
+  for(int i{0}; i < 4; i++) {
+    points.push_back(Coord2D{static_cast<double>(i), 0});
+    points.push_back(Coord2D{4, static_cast<double>(i)});
+    points.push_back(Coord2D{4 - static_cast<double>(i), 4});
+    points.push_back(Coord2D{0, 4 - static_cast<double>(i)});
+  }
+  std::vector<Coord2D> hole{{1.5, 1.5}, {2.5, 1.5}, {2.5, 2.5}, {1.5, 2.5}};
+  points.insert(points.end(), hole.begin(), hole.end());
+  points.push_back(Coord2D{0.5, 0.25});
+  points.push_back(Coord2D{3.5, 0.25});
+  points.push_back(Coord2D{1.2, 0.5});
+  points.push_back(Coord2D{2.7, 0.5});
+
+  std::vector<Coord2D> outer{{0, 0}, {4, 0}, {4, 4}, {0, 4}};
+  std::vector<Edge> segments;
+  for(int i{0}; i < 4; i++) {
+    segments.emplace_back(Node{outer[i]}, Node{outer[(i+1)%4]});
+    segments.emplace_back(Node{hole[i]}, Node{hole[(i+1)%4]});
+  }
+  segments.emplace_back(Node{Coord2D{0.5, 0.25}}, Node{Coord2D{3.5, 0.25}});
+
+  // Unconstrained triangulation does not contain the inner segment
+  Delaunay unconstrained{points};
+  unconstrained.compute();
+  std::vector<std::array<int, 2>> edges{unconstrained.get_edges_index()};
+  ASSERT_EQ(std::count(edges.begin(), edges.end(), std::array<int, 2>{20, 21}), 0);
+
+  Delaunay d{points, segments};
+  d.compute();
+
+  // Every segment is an edge (outer sides are split by the nodes lying on them)
+  edges = d.get_edges_index();
+  std::vector<std::array<int, 2>> constraints{d.get_constraints_index()};
+  ASSERT_EQ(constraints.size(), 4*4 + 4 + 1);
+  for(const std::array<int, 2>& constraint: constraints) {
+    ASSERT_EQ(std::count(edges.begin(), edges.end(), constraint), 1);
+  }
+  ASSERT_EQ(std::count(constraints.begin(), constraints.end(), std::array<int, 2>{20, 21}), 1);
+
+  // Only the triangles of the domain are kept
+  ASSERT_NO_FATAL_FAILURE(expect_constrained_domain(d, 15));
+
+  // Refinement does not insert nodes outside the domain
+  d.refine(25 * M_PI / 180, 0.5);
+  ASSERT_NO_FATAL_FAILURE(expect_constrained_domain(d, 15));
+  for(Node& node: d.get_nodes()) {
+    Coord2D p{node.get_coords()};
+    ASSERT_TRUE(p.x >= 0 && p.x <= 4 && p.y >= 0 && p.y <= 4);
+    ASSERT_FALSE(p.x > 1.5 + eps && p.x < 2.5 - eps && p.y > 1.5 + eps && p.y < 2.5 - eps);
+  }
+  ASSERT_TRUE(d.get_bad_triangles(20 * M_PI / 180).empty());
+}
+
+
+TEST(DelaunayTest, ViewTest) {
+  std::mt19937 gen(2);
+  std::uniform_real_distribution<double> dis(0.0, 1.0);
+
+  std::vector<Coord2D> points;
+  for(int i{0}; i < 1000; i++) {
+    points.push_back(Coord2D{dis(gen), dis(gen)});
+  }
+  Delaunay d{points};
+  d.compute();
+
+  // Views match the copying getters
+  View<std::array<int, 3>> triangles{d.get_triangles_view()};
+  std::vector<std::array<int, 3>> triangles_index{d.get_triangles_index()};
+  ASSERT_EQ(triangles.size(), triangles_index.size());
+  ASSERT_TRUE(std::equal(triangles.begin(), triangles.end(), triangles_index.begin()));
+  View<std::array<int, 2>> edges{d.get_edges_view()};
+  std::vector<std::array<int, 2>> edges_index{d.get_edges_index()};
+  ASSERT_EQ(edges.size(), edges_index.size());
+  ASSERT_TRUE(std::equal(edges.begin(), edges.end(), edges_index.begin()));
+  ASSERT_EQ(d.get_x().size(), points.size());
+  for(size_t v{0}; v < points.size(); v++) {
+    ASSERT_EQ(Coord2D(d.get_x()[v], d.get_y()[v]), d.get_nodes()[v].get_coords());
+  }
+
+  // Cached until the triangulation changes
+  ASSERT_EQ(d.get_triangles_view().data(), triangles.data());
+  ASSERT_EQ(d.get_edges_view().data(), edges.data());
+  d.add_point(Coord2D{0.5, 0.5});
+  ASSERT_EQ(d.get_triangles_view().size(), triangles_index.size() + 2);
+  ASSERT_EQ(d.get_triangles_view().size(), d.get_triangles().size());
+  ASSERT_EQ(d.get_edges_view().size(), edges_index.size() + 3);
+
+  // Concurrent readers of an unread cache see the same views
+  d.add_point(Coord2D{0.25, 0.25});
+  const Delaunay& shared{d};
+  std::vector<size_t> sizes(8);
+  std::vector<std::thread> readers;
+  for(size_t i{0}; i < sizes.size(); i++) {
+    readers.emplace_back([&, i]() {
+      sizes[i] = (i % 2) ? shared.get_edges_view().size() : shared.get_triangles_view().size();
+    });
+  }
+  for(std::thread& reader: readers) {
+    reader.join();
+  }
+  for(size_t i{0}; i < sizes.size(); i++) {
+    ASSERT_EQ(sizes[i], (i % 2) ? edges_index.size() + 6 : triangles_index.size() + 4);
+  }
+}
+
+
+TEST(DelaunayTest, AddPointsTest) {
+  std::mt19937 gen(3);
+  std::uniform_real_distribution<double> dis(0.0, 1.0);
+
+  std::vector<Coord2D> points;
+  for(int i{0}; i < 2000; i++) {
+    points.push_back(Coord2D{dis(gen), dis(gen)});
+  }
+  std::vector<Coord2D> batch;
+  for(int i{0}; i < 500; i++) {
+    batch.push_back(Coord2D{0.4 + 0.2*dis(gen), 0.4 + 0.2*dis(gen)});
+  }
+  batch.push_back(points[10]); // duplicate is not inserted
+
+  Delaunay d{points};
+  d.compute();
+  std::vector<std::array<int, 3>> before{d.get_triangles_index()};
+  Insertion insertion{d.add_points(batch)};
+  ASSERT_EQ(insertion.nodes.size(), batch.size());
+  for(int i{0}; i < 500; i++) {
+    ASSERT_EQ(insertion.nodes[i], 2000 + i);
+  }
+  ASSERT_EQ(insertion.nodes.back(), -1);
+
+  // Previous triangles minus destroyed plus created ones give the new triangulation
+  std::vector<std::array<int, 3>> expected;
+  std::sort(before.begin(), before.end());
+  std::set_difference(before.begin(), before.end(), insertion.destroyed.begin(), insertion.destroyed.end(),
+                      std::back_inserter(expected));
+  expected.insert(expected.end(), insertion.created.begin(), insertion.created.end());
+  std::sort(expected.begin(), expected.end());
+  std::vector<std::array<int, 3>> after{d.get_triangles_index()};
+  std::sort(after.begin(), after.end());
+  ASSERT_EQ(expected, after);
+
+  // Same triangulation as computing all points at once
+  std::vector<Coord2D> all{points};
+  all.insert(all.end(), batch.begin(), batch.end() - 1);
+  Delaunay full{all};
+  full.compute();
+  std::vector<std::array<int, 3>> full_triangles{full.get_triangles_index()};
+  std::sort(full_triangles.begin(), full_triangles.end());
+  ASSERT_EQ(full_triangles, after);
+
+  // Points outside the super triangle are rejected without modifying the triangulation
+  ASSERT_THROW(d.add_points({Coord2D{1e9, 1e9}}), std::out_of_range);
+  ASSERT_EQ(d.get_nodes_count(), 2501);
+}
+
+
+TEST(DelaunayTest, CompactTest) {
+  std::mt19937 gen(4);
+  std::uniform_real_distribution<double> dis(0.0, 1.0);
+
+  std::vector<Coord2D> points;
+  for(int i{0}; i < 1000; i++) {
+    points.push_back(Coord2D{dis(gen), dis(gen)});
+  }
+  Delaunay d{points};
+  d.compute();
+  for(int i{0}; i < 200; i++) {
+    d.add_point(dis(gen), dis(gen));
+  }
+  std::vector<std::array<int, 3>> triangles{d.get_triangles_index()};
+  std::sort(triangles.begin(), triangles.end());
+
+  // Compaction sorts the triangles and keeps the adjacency consistent
+  d.compact();
+  std::vector<std::array<int, 3>> compacted{d.get_triangles_index()};
+  ASSERT_TRUE(std::is_sorted(compacted.begin(), compacted.end()));
+  ASSERT_EQ(compacted, triangles);
+  std::vector<std::array<int, 3>> neighbors{d.get_neighbors_index()};
+  for(size_t t{0}; t < compacted.size(); t++) {
+    for(int k{0}; k < 3; k++) {
+      int neighbor{neighbors[t][k]};
+      if(neighbor != -1) {
+        ASSERT_NE(std::find(neighbors[neighbor].begin(), neighbors[neighbor].end(), static_cast<int>(t)),
+                  neighbors[neighbor].end());
+      }
+    }
+  }
+
+  // Insertion keeps working after compaction
+  d.add_point(0.5, 0.5);
+  ASSERT_EQ(d.get_triangles_index().size(), compacted.size() + 2);
+}
+
+
+TEST(DelaunayTest, ParallelRefineTest) {
+  std::vector<Coord2D> points{circle_with_points(5)};
+  double alpha{25 * M_PI / 180};
+
+  // Same guarantees as the serial refinement and a Delaunay triangulation
+  Delaunay quality{points};
+  quality.compute();
+  quality.refine(alpha, 10, 4);
+  ASSERT_EQ(0, quality.get_bad_triangles(alpha).size());
+  Delaunay d1{points};
+  d1.compute();
+  d1.refine(alpha, 0.1, 4);
+  ASSERT_EQ(0, d1.get_big_triangles(0.1).size());
+  std::vector<Node> nodes{d1.get_nodes()};
+  for(Triangle& t: d1.get_triangles()) {
+    std::array<Node, 3> v{t.get_vertices()};
+    for(Node& node: nodes) {
+      ASSERT_FALSE(in_circumcircle(v[0].get_coords(), v[1].get_coords(), v[2].get_coords(), node.get_coords()));
+    }
+  }
+
+  // Results do not depend on the number of threads
+  Delaunay d2{points};
+  d2.compute();
+  d2.refine(alpha, 0.1, 2);
+  ASSERT_EQ(d1.get_triangles_index(), d2.get_triangles_index());
+  ASSERT_EQ(d1.get_neighbors_index(), d2.get_neighbors_index());
+
+  // Constrained mode: square with a hole
+  Domain domain{square_with_hole()};
+  Delaunay c1{domain.points, domain.segments};
+  Delaunay c2{domain.points, domain.segments};
+  c1.compute();
+  c2.compute();
+  c1.refine(alpha, 0.3, 4);
+  c2.refine(alpha, 0.3, 3);
+  ASSERT_EQ(c1.get_triangles_index(), c2.get_triangles_index());
+  ASSERT_TRUE(c1.get_bad_triangles(alpha).empty());
+  ASSERT_TRUE(c1.get_big_triangles(0.3).empty());
+  ASSERT_NO_FATAL_FAILURE(expect_constrained_domain(c1, 15));
+}
+
+TEST(DelaunayTest, OffcenterRefineTest) {
+  std::vector<Coord2D> points{circle_with_points(7)};
+
+  // Same angle bound with fewer Steiner points, serial and parallel
+  for(double degrees: {25.0, 30.0}) {
+    double alpha{degrees * M_PI / 180};
+    for(int threads: {1, 2}) {
+      Delaunay circumcenters{points};
+      Delaunay offcenters{points};
+      circumcenters.compute();
+      offcenters.compute();
+      circumcenters.refine(alpha, 10, threads);
+      offcenters.refine(alpha, 10, threads, Placement::offcenter);
+      ASSERT_EQ(0, offcenters.get_bad_triangles(alpha).size());
+      ASSERT_LT(offcenters.get_nodes_count(), circumcenters.get_nodes_count());
+    }
+  }
+
+  // Constrained mode: square with a hole
+  Domain domain{square_with_hole()};
+  double alpha{30 * M_PI / 180};
+  Delaunay c1{domain.points, domain.segments};
+  Delaunay c2{domain.points, domain.segments};
+  c1.compute();
+  c2.compute();
+  c1.refine(alpha, 10);
+  c2.refine(alpha, 10, 1, Placement::offcenter);
+  ASSERT_TRUE(c2.get_bad_triangles(alpha).empty());
+  ASSERT_LE(c2.get_nodes_count(), c1.get_nodes_count());
+  ASSERT_NO_FATAL_FAILURE(expect_constrained_domain(c2, 15));
+}
+
+TEST(DelaunayTest, LawsonEngineTest) {
+  std::mt19937 gen(11);
+  std::uniform_real_distribution<double> dis(0.0, 1.0);
+
+  std::vector<Coord2D> points;
+  for(int i{0}; i < 2000; i++) {
+    points.push_back(Coord2D{dis(gen), dis(gen)});
+  }
+  // Nodes on existing edges and cocircular nodes
+  for(int i{0}; i < 10; i++) {
+    for(int j{0}; j < 10; j++) {
+      points.push_back(Coord2D{1.5 + 0.1*i, 0.1*j});
+    }
+  }
+
+  // Same triangulation as Bowyer-Watson (only the grid may be split differently)
+  auto sorted_triangles = [](const Delaunay& d) {
+    std::vector<std::array<int, 3>> result{d.get_triangles_index()};
+    std::sort(result.begin(), result.end());
+    return result;
+  };
+  Delaunay bowyer_watson{points};
+  Delaunay lawson{points, Engine::lawson};
+  bowyer_watson.compute();
+  lawson.compute();
+  ASSERT_EQ(bowyer_watson.get_triangles_index().size(), lawson.get_triangles_index().size());
+  std::vector<Node> nodes{lawson.get_nodes()};
+  for(Triangle& t: lawson.get_triangles()) {
+    std::array<Node, 3> v{t.get_vertices()};
+    ASSERT_GT(t.get_area(), 0);
+    for(Node& node: nodes) {
+      ASSERT_FALSE(in_circumcircle(v[0].get_coords(), v[1].get_coords(), v[2].get_coords(), node.get_coords()));
+    }
+  }
+
+  // Batch insertion reports the same changes
+  std::vector<Coord2D> batch;
+  for(int i{0}; i < 300; i++) {
+    batch.push_back(Coord2D{0.4 + 0.2*dis(gen), 0.4 + 0.2*dis(gen)});
+  }
+  std::vector<std::array<int, 3>> before{sorted_triangles(lawson)};
+  Insertion expected{bowyer_watson.add_points(batch)};
+  Insertion insertion{lawson.add_points(batch)};
+  ASSERT_EQ(expected.nodes, insertion.nodes);
+  ASSERT_EQ(expected.created, insertion.created);
+  ASSERT_EQ(expected.destroyed, insertion.destroyed);
+  ASSERT_EQ(sorted_triangles(bowyer_watson), sorted_triangles(lawson));
+  ASSERT_EQ(lawson.get_neighbors_index().size(), lawson.get_triangles_index().size());
+
+  // Constrained refinement: square with a hole
+  Domain domain{square_with_hole()};
+  double alpha{25 * M_PI / 180};
+  Delaunay c{domain.points, domain.segments, Engine::lawson};
+  c.compute();
+  c.refine(alpha, 0.3);
+  ASSERT_TRUE(c.get_bad_triangles(alpha).empty());
+  ASSERT_TRUE(c.get_big_triangles(0.3).empty());
+  ASSERT_NO_FATAL_FAILURE(expect_constrained_domain(c, 15));
+}
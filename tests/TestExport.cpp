@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+
+#include <Mesh.hpp>
+#include <Export.hpp>
+
+
+static std::string read_file(const std::string& filename) {
+  std::ifstream file{filename, std::ios::binary};
+  std::stringstream content;
+  content << file.rdbuf();
+  return content.str();
+}
+
+static const Delaunay& square_with_hole() {
+  static Mesh msh{Boundary::combine(Boundary::line(Coord2D{0, 0}, Coord2D{4, 0}, 0.5),
+                                    Boundary::line(Coord2D{4, 0}, Coord2D{4, 4}, 0.5),
+                                    Boundary::line(Coord2D{4, 4}, Coord2D{0, 4}, 0.5),
+                                    Boundary::line(Coord2D{0, 4}, Coord2D{0, 0}, 0.5),
+                                    Boundary::circle(Coord2D{2, 2}, 1, 0.2)), 0.5};
+  return msh.get_triangulation();
+}
+
+TEST(ExportTest, Obj) {
+  const Delaunay& d = square_with_hole();
+  Export::obj(d, "trimesh_test.obj");
+  std::ifstream file{"trimesh_test.obj"};
+  std::string line;
+  int vertices{0};
+  std::vector<std::array<int, 3>> faces;
+  while(std::getline(file, line)) {
+    std::istringstream tokens{line};
+    std::string kind;
+    tokens >> kind;
+    if(kind == "v") {
+      double x, y, z;
+      tokens >> x >> y >> z;
+      ASSERT_EQ(Coord2D(x, y), d.get_nodes()[vertices].get_coords());
+      vertices++;
+    } else if(kind == "f") {
+      std::array<int, 3> f;
+      tokens >> f[0] >> f[1] >> f[2];
+      faces.push_back(f);
+    }
+  }
+  ASSERT_EQ(vertices, d.get_nodes_count());
+  ASSERT_EQ(faces.size(), d.get_triangles_index().size());
+
+  // Faces are 1-based and counter-clockwise
+  std::vector<Node> nodes{d.get_nodes()};
+  for(const std::array<int, 3>& f: faces) {
+    Coord2D a{nodes[f[0]-1].get_coords()}, b{nodes[f[1]-1].get_coords()}, c{nodes[f[2]-1].get_coords()};
+    ASSERT_GT((b.x - a.x)*(c.y - a.y) - (b.y - a.y)*(c.x - a.x), 0);
+  }
+  std::remove("trimesh_test.obj");
+}
+
+TEST(ExportTest, Vtk) {
+  const Delaunay& d = square_with_hole();
+  size_t n{static_cast<size_t>(d.get_nodes_count())};
+  size_t t{d.get_triangles_index().size()};
+
+  Export::vtk(d, "trimesh_test.vtk");
+  std::string ascii{read_file("trimesh_test.vtk")};
+  ASSERT_EQ(ascii.rfind("# vtk DataFile Version 3.0\n", 0), 0);
+  ASSERT_NE(ascii.find("POINTS " + std::to_string(n) + " double\n"), std::string::npos);
+  ASSERT_NE(ascii.find("CELLS " + std::to_string(t) + " " + std::to_string(4*t) + "\n"), std::string::npos);
+  ASSERT_NE(ascii.find("CELL_TYPES " + std::to_string(t) + "\n"), std::string::npos);
+
+  Export::vtk(d, "trimesh_test.vtk", true);
+  std::string binary{read_file("trimesh_test.vtk")};
+  ASSERT_NE(binary.find("BINARY\n"), std::string::npos);
+  size_t points{binary.find(" double\n") + 8};
+  // First coordinate is big endian
+  uint64_t bits{0};
+  for(int i{0}; i < 8; i++) {
+    bits = (bits << 8) | static_cast<unsigned char>(binary[points + i]);
+  }
+  double x;
+  std::memcpy(&x, &bits, sizeof(double));
+  ASSERT_EQ(x, d.get_nodes()[0].get_coords().x);
+  std::string header{"# vtk DataFile Version 3.0\ntrimesh\nBINARY\nDATASET UNSTRUCTURED_GRID\nPOINTS "
+                     + std::to_string(n) + " double\n"};
+  std::string cells{"\nCELLS " + std::to_string(t) + " " + std::to_string(4*t) + "\n"};
+  std::string types{"\nCELL_TYPES " + std::to_string(t) + "\n"};
+  ASSERT_EQ(binary.size(), header.size() + 24*n + cells.size() + 16*t + types.size() + 4*t + 1);
+  std::remove("trimesh_test.vtk");
+}
+
+TEST(ExportTest, Vtu) {
+  const Delaunay& d = square_with_hole();
+  size_t n{static_cast<size_t>(d.get_nodes_count())};
+  size_t t{d.get_triangles_index().size()};
+
+  for(bool binary: {false, true}) {
+    Export::vtu(d, "trimesh_test.vtu", binary);
+    std::string content{read_file("trimesh_test.vtu")};
+    ASSERT_NE(content.find("NumberOfPoints=\"" + std::to_string(n) + "\" NumberOfCells=\"" + std::to_string(t) + "\""),
+              std::string::npos);
+    ASSERT_EQ(content.substr(content.size() - 11), "</VTKFile>\n");
+    if(binary) {
+      size_t start{content.find("encoding=\"raw\">\n_") + 17};
+      uint64_t size;
+      std::memcpy(&size, content.data() + start, sizeof(uint64_t));
+      ASSERT_EQ(size, 24*n);
+      double coords[3];
+      std::memcpy(coords, content.data() + start + 8, sizeof(coords));
+      ASSERT_EQ(Coord2D(coords[0], coords[1]), d.get_nodes()[0].get_coords());
+      size_t end{content.find("\n  </AppendedData>")};
+      ASSERT_EQ(end - start, 32 + 24*n + 12*t + 4*t + t);
+    }
+  }
+  std::remove("trimesh_test.vtu");
+}
+
+TEST(ExportTest, Msh) {
+  const Delaunay& d = square_with_hole();
+  size_t n{static_cast<size_t>(d.get_nodes_count())};
+  size_t t{d.get_triangles_index().size()};
+  size_t s{d.get_constraints_index().size()};
+  ASSERT_GT(s, 0);
+
+  Export::msh(d, "trimesh_test.msh");
+  std::ifstream file{"trimesh_test.msh"};
+  std::string line;
+  std::getline(file, line);
+  ASSERT_EQ(line, "$MeshFormat");
+  std::getline(file, line);
+  ASSERT_EQ(line, "4.1 0 8");
+  while(std::getline(file, line) && line != "$Elements");
+  std::getline(file, line);
+  ASSERT_EQ(line, "2 " + std::to_string(s + t) + " 1 " + std::to_string(s + t));
+  std::getline(file, line);
+  ASSERT_EQ(line, "1 1 1 " + std::to_string(s));
+  for(size_t i{0}; i < s; i++) {
+    std::getline(file, line);
+  }
+  std::getline(file, line);
+  ASSERT_EQ(line, "2 1 2 " + std::to_string(t));
+  file.close();
+
+  Export::msh(d, "trimesh_test.msh", true);
+  std::string binary{read_file("trimesh_test.msh")};
+  ASSERT_EQ(binary.rfind("$MeshFormat\n4.1 1 8\n", 0), 0);
+  int32_t one;
+  std::memcpy(&one, binary.data() + 20, sizeof(int32_t));
+  ASSERT_EQ(one, 1);
+  size_t nodes{8*4 + 12 + 8 + 8*n + 24*n};
+  size_t elements{8*4 + 2*(12 + 8) + 24*s + 32*t};
+  ASSERT_EQ(binary.size(), std::string("$MeshFormat\n4.1 1 8\n").size() + 4 + std::string("\n$EndMeshFormat\n").size()
+                           + std::string("$Nodes\n").size() + nodes + std::string("\n$EndNodes\n").size()
+                           + std::string("$Elements\n").size() + elements + std::string("\n$EndElements\n").size());
+  std::remove("trimesh_test.msh");
+}
+
+TEST(ExportTest, InvalidFile) {
+  const Delaunay& d = square_with_hole();
+  ASSERT_THROW(Export::obj(d, "missing_directory/trimesh_test.obj"), std::runtime_error);
+}
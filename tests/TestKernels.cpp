@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <cmath>
+
+#include <Delaunay.hpp>
+#include <Kernels.hpp>
+
+
+// Random triangles (block size not a multiple of the vector width, so the scalar tail is used too)
+struct Triangles {
+  std::vector<double> ax, ay, bx, by, cx, cy;
+  Kernels::TriangleBlock block() const {
+    return Kernels::TriangleBlock{ax.data(), ay.data(), bx.data(), by.data(), cx.data(), cy.data(), ax.size()};
+  }
+};
+
+static Triangles random_triangles(int n) {
+  std::mt19937 gen(1);
+  std::uniform_real_distribution<double> dis(-1.0, 1.0);
+  Triangles t;
+  for(int i{0}; i < n; i++) {
+    t.ax.push_back(dis(gen));
+    t.ay.push_back(dis(gen));
+    t.bx.push_back(dis(gen));
+    t.by.push_back(dis(gen));
+    t.cx.push_back(dis(gen));
+    t.cy.push_back(dis(gen));
+  }
+  return t;
+}
+
+TEST(KernelsTest, MinAngle) {
+  Triangles t{random_triangles(1003)};
+  std::vector<double> cosines(t.ax.size());
+  Kernels::min_angle_cosines(t.block(), cosines.data());
+  for(size_t i{0}; i < cosines.size(); i++) {
+    Coord2D a{t.ax[i], t.ay[i]}, b{t.bx[i], t.by[i]}, c{t.cx[i], t.cy[i]};
+    // Same result as the single triangle kernel (AVX2 or not) and the angle of min_angle
+    ASSERT_DOUBLE_EQ(cosines[i], Kernels::min_angle_cosine(a, b, c));
+    ASSERT_NEAR(std::acos(std::min(1.0, cosines[i])), min_angle(a, b, c), 1e-6);
+  }
+
+  // Equilateral triangle
+  ASSERT_NEAR(Kernels::min_angle_cosine(Coord2D{0, 0}, Coord2D{1, 0}, Coord2D{0.5, std::sqrt(3) / 2}), 0.5, 1e-12);
+}
+
+TEST(KernelsTest, SignedArea) {
+  Triangles t{random_triangles(1003)};
+  std::vector<double> areas(t.ax.size());
+  Kernels::signed_areas(t.block(), areas.data());
+  for(size_t i{0}; i < areas.size(); i++) {
+    Coord2D a{t.ax[i], t.ay[i]}, b{t.bx[i], t.by[i]}, c{t.cx[i], t.cy[i]};
+    ASSERT_DOUBLE_EQ(areas[i], Kernels::signed_area(a, b, c));
+    ASSERT_DOUBLE_EQ(std::abs(areas[i]), area(a, b, c));
+  }
+
+  // Orientation gives the sign
+  ASSERT_DOUBLE_EQ(Kernels::signed_area(Coord2D{0, 0}, Coord2D{1, 0}, Coord2D{0, 1}), 0.5);
+  ASSERT_DOUBLE_EQ(Kernels::signed_area(Coord2D{0, 0}, Coord2D{0, 1}, Coord2D{1, 0}), -0.5);
+}
+
+TEST(KernelsTest, QualitySweeps) {
+  std::mt19937 gen(2);
+  std::uniform_real_distribution<double> dis(0.0, 1.0);
+  std::vector<Coord2D> points;
+  for(int i{0}; i < 2000; i++) {
+    points.push_back(Coord2D{dis(gen), dis(gen)});
+  }
+  Delaunay d{points};
+  d.compute();
+  std::vector<Triangle> triangles{d.get_triangles()};
+
+  // Sweeps agree with the triangle by triangle checks
+  double alpha{25 * M_PI / 180};
+  double h{0.02};
+  size_t bad{0}, big{0};
+  for(Triangle& t: triangles) {
+    bad += t.get_alpha() < alpha;
+    big += t.get_area() > 0.5*h*h;
+  }
+  ASSERT_GT(bad, 0);
+  ASSERT_GT(big, 0);
+  ASSERT_EQ(d.get_bad_triangles(alpha).size(), bad);
+  ASSERT_EQ(d.get_big_triangles(h).size(), big);
+  ASSERT_EQ(d.get_big_triangles([h](const Coord2D&) { return h; }).size(), big);
+}
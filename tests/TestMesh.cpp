@@ -43,4 +43,263 @@ TEST(MeshTest, AirfoilFlowGeneration) {
     Mesh msh{b, h};
     Delaunay d = msh.get_triangulation();
     Plot::plot_mesh(d.get_edges());
-}
\ No newline at end of file
+}
+
+TEST(MeshTest, TriangulationQueries) {
+    double h{0.5};
+    auto b = Boundary::combine(Boundary::line(Coord2D{0, 0}, Coord2D{4, 0}, h),
+                               Boundary::line(Coord2D{4, 0}, Coord2D{4, 4}, h),
+                               Boundary::line(Coord2D{4, 4}, Coord2D{0, 4}, h),
+                               Boundary::line(Coord2D{0, 4}, Coord2D{0, 0}, h));
+    Mesh msh{b, h};
+
+    // Read-only queries are available on the returned reference
+    std::vector<Triangle> triangles{msh.get_triangulation().get_triangles()};
+    ASSERT_EQ(msh.get_triangulation().get_bad_triangles(M_PI / 3).size(), triangles.size());
+    ASSERT_TRUE(msh.get_triangulation().get_big_triangles(h).empty());
+    ASSERT_TRUE(msh.get_triangulation().get_big_triangles([h](const Coord2D&) { return h; }).empty());
+    ASSERT_FALSE(msh.get_triangulation().get_neighbors(triangles[0]).empty());
+}
+
+TEST(MeshTest, InsideDomain) {
+    double h{0.5};
+    auto wall1 = Boundary::line(Coord2D{0, 0}, Coord2D{4, 0}, h);
+    auto wall2 = Boundary::line(Coord2D{4, 0}, Coord2D{4, 4}, h);
+    auto wall3 = Boundary::line(Coord2D{4, 4}, Coord2D{0, 4}, h);
+    auto wall4 = Boundary::line(Coord2D{0, 4}, Coord2D{0, 0}, h);
+    auto hole = Boundary::circle(Coord2D{2, 2}, 1, 0.2);
+
+    auto b = Boundary::combine(wall1, wall2, wall3, wall4, hole);
+    Mesh msh{b, h};
+
+    std::vector<Coord2D> points;
+    for(int i{-10}; i <= 50; i++) {
+        for(int j{-10}; j <= 50; j++) {
+            points.push_back(Coord2D{0.1*i + 0.013, 0.1*j + 0.007});
+        }
+    }
+    std::vector<bool> inside{msh.inside_domain(points, 4)};
+    ASSERT_EQ(inside.size(), points.size());
+    for(size_t i{0}; i < points.size(); i++) {
+        const Coord2D& p{points[i]};
+        bool expected{p.x > 0 && p.x < 4 && p.y > 0 && p.y < 4 && dist(p, Coord2D{2, 2}) > 1};
+        // Points close to the polygonal hole boundary are not checked
+        if(std::abs(dist(p, Coord2D{2, 2}) - 1) > 0.05) {
+            ASSERT_EQ(inside[i], expected);
+        }
+        ASSERT_EQ(inside[i], msh.inside_domain(p));
+    }
+}
+
+
+TEST(MeshTest, Triangulation) {
+    double h{0.5};
+    auto wall1 = Boundary::line(Coord2D{0, 0}, Coord2D{4, 0}, h);
+    auto wall2 = Boundary::line(Coord2D{4, 0}, Coord2D{4, 4}, h);
+    auto wall3 = Boundary::line(Coord2D{4, 4}, Coord2D{0, 4}, h);
+    auto wall4 = Boundary::line(Coord2D{0, 4}, Coord2D{0, 0}, h);
+    auto hole = Boundary::circle(Coord2D{2, 2}, 1, 0.2);
+
+    auto b = Boundary::combine(wall1, wall2, wall3, wall4, hole);
+    Mesh msh{b, h};
+
+    // Result is cached
+    const Delaunay& d = msh.get_triangulation();
+    ASSERT_EQ(&d, &msh.get_triangulation());
+
+    // Area of the square minus the polygonal hole
+    int sides{static_cast<int>(2*M_PI / 0.2)};
+    double hole_area{0.5 * sides * sin(2*M_PI / sides)};
+    double total{0};
+    std::vector<Triangle> triangles{d.get_triangles()};
+    for(Triangle& t: triangles) {
+        total += t.get_area();
+    }
+    ASSERT_NEAR(total, 16 - hole_area, 1e-9);
+
+    // Every node is used (the hole center is dropped) and adjacency is symmetric
+    std::vector<int> used(d.get_nodes_count(), 0);
+    for(const std::array<int, 3>& t: d.get_triangles_index()) {
+        for(int v: t) {
+            used[v] = 1;
+        }
+    }
+    ASSERT_EQ(std::count(used.begin(), used.end(), 0), 0);
+    std::vector<std::array<int, 3>> neighbors{d.get_neighbors_index()};
+    ASSERT_EQ(neighbors.size(), triangles.size());
+    for(size_t t{0}; t < neighbors.size(); t++) {
+        for(int neighbor: neighbors[t]) {
+            if(neighbor != -1) {
+                ASSERT_EQ(std::count(neighbors[neighbor].begin(), neighbors[neighbor].end(), static_cast<int>(t)), 1);
+            }
+        }
+    }
+}
+
+
+TEST(MeshTest, Combine) {
+    // Reference: combine boundaries one by one comparing every pair of nodes
+    auto combine_pairwise = [](std::vector<Boundary> boundaries) {
+        std::vector<Node> nodes{boundaries[0].get_nodes()};
+        std::vector<Edge> edges{boundaries[0].get_edges()};
+        for(size_t b{1}; b < boundaries.size(); b++) {
+            std::vector<Node> previous{nodes};
+            int i = nodes.size();
+            for(Node& node: boundaries[b].get_nodes()) {
+                if(std::find(previous.begin(), previous.end(), node) == previous.end()) {
+                    node.set_index(i++);
+                    nodes.push_back(node);
+                }
+            }
+            std::vector<Edge> added{boundaries[b].get_edges()};
+            edges.insert(edges.end(), added.begin(), added.end());
+            edges.push_back(Edge{nodes.back(), nodes.back()});
+        }
+        return Boundary{nodes, edges};
+    };
+
+    double h{0.1};
+    auto wall1 = Boundary::line(Coord2D{-5, -2.5}, Coord2D{5, -2.5}, h);
+    auto wall2 = Boundary::line(Coord2D{-5, 2.5}, Coord2D{5, 2.5}, h);
+    auto inlet = Boundary::line(Coord2D{-5, -2.5}, Coord2D{-5, 2.5}, h);
+    auto outlet = Boundary::line(Coord2D{5, -2.5}, Coord2D{5, 2.5}, h);
+    auto cylinder = Boundary::circle(Coord2D{0, 0}, 1, 0.05);
+    auto airfoil = Boundary::naca("2412", 1);
+    // Nodes closer than eps to existing ones are repeated
+    auto shifted = Boundary::line(Coord2D{-5 + 0.4*eps, -2.5}, Coord2D{-5 - 0.4*eps, 2.5}, 0.5);
+
+    // Coordinates too large for a grid cell are compared pairwise
+    double far{1e12};
+    auto far1 = Boundary::line(Coord2D{far, 0}, Coord2D{far + 1, 0}, 0.5);
+    auto far2 = Boundary::line(Coord2D{far + 1, 0}, Coord2D{far + 1, 1}, 0.5);
+    auto far3 = Boundary::line(Coord2D{-5, -2.5}, Coord2D{far, 0}, far / 2);
+
+    std::vector<std::vector<Boundary>> cases{
+        {inlet, wall1, outlet, wall2, cylinder, airfoil, shifted},
+        {inlet, far1, wall1, far2, far3}
+    };
+    for(std::vector<Boundary>& boundaries: cases) {
+        Boundary combined{Boundary::combine(boundaries)};
+        Boundary expected{combine_pairwise(boundaries)};
+
+        std::vector<Node> nodes{combined.get_nodes()}, expected_nodes{expected.get_nodes()};
+        ASSERT_EQ(nodes.size(), expected_nodes.size());
+        for(size_t i{0}; i < nodes.size(); i++) {
+            ASSERT_EQ(nodes[i].get_index(), expected_nodes[i].get_index());
+            ASSERT_EQ(nodes[i].get_x(), expected_nodes[i].get_x());
+            ASSERT_EQ(nodes[i].get_y(), expected_nodes[i].get_y());
+        }
+        std::vector<Edge> edges{combined.get_edges()}, expected_edges{expected.get_edges()};
+        ASSERT_EQ(edges.size(), expected_edges.size());
+        for(size_t i{0}; i < edges.size(); i++) {
+            ASSERT_EQ(edges[i].get_vertices_index(), expected_edges[i].get_vertices_index());
+            ASSERT_TRUE(edges[i] == expected_edges[i]);
+        }
+    }
+    // Four line ends are shared
+    Boundary combined{Boundary::combine(cases[1])};
+    ASSERT_EQ(combined.get_nodes().size(), inlet.get_nodes().size() + far1.get_nodes().size() + wall1.get_nodes().size()
+              + far2.get_nodes().size() + far3.get_nodes().size() - 4);
+}
+
+
+TEST(MeshTest, SizeField) {
+    double Lx{10};
+    double Ly{5};
+    double h{0.5};
+    double h_cylinder{0.05};
+    auto wall1 = Boundary::line(Coord2D{-Lx/2, -Ly/2}, Coord2D{Lx/2, -Ly/2}, h);
+    auto wall2 = Boundary::line(Coord2D{-Lx/2, Ly/2}, Coord2D{Lx/2, Ly/2}, h);
+    auto inlet = Boundary::line(Coord2D{-Lx/2, -Ly/2}, Coord2D{-Lx/2, Ly/2}, h);
+    auto outlet = Boundary::line(Coord2D{Lx/2, -Ly/2}, Coord2D{Lx/2, Ly/2}, h);
+    auto cylinder = Boundary::circle(Coord2D{0, 0}, 1, h_cylinder);
+    auto b = Boundary::combine(inlet, wall1, outlet, wall2, cylinder);
+
+    // Size follows the boundary segments and grows away from them
+    BoundarySizeField size{b, h};
+    double segment{2 * sin(M_PI / static_cast<int>(2*M_PI / h_cylinder))};
+    ASSERT_NEAR(size(Coord2D{1, 0}), segment, 0.2 * segment);
+    ASSERT_NEAR(size(Coord2D{1.5, 0}), segment + 0.2 * 0.5, 0.02);
+    ASSERT_NEAR(size(Coord2D{-3, 0}), segment + 0.2 * 2, 0.02);
+    ASSERT_NEAR(size(Coord2D{-4.5, 0}), h, 1e-12);
+    ASSERT_NEAR(size(Coord2D{-3, Ly/2}), h, 1e-12);
+
+    // Graded mesh: fine next to the cylinder with far fewer triangles than a uniform one
+    Mesh graded{b, size};
+    Mesh uniform{b, h_cylinder};
+    const Delaunay& d = graded.get_triangulation();
+    size_t graded_count{d.get_triangles_view().size()};
+    ASSERT_LT(10 * graded_count, uniform.get_triangulation().get_triangles_view().size());
+    double total{0};
+    for(Triangle& t: d.get_triangles()) {
+        double leg{size(t.centroid())};
+        ASSERT_LE(t.get_area(), 0.5 * leg * leg * (1 + 1e-9));
+        total += t.get_area();
+    }
+    int sides{static_cast<int>(2*M_PI / h_cylinder)};
+    ASSERT_NEAR(total, Lx * Ly - 0.5 * sides * sin(2*M_PI / sides), 1e-9);
+}
+
+TEST(MeshTest, Smoothing) {
+    auto square = Boundary::combine(Boundary::line(Coord2D{0, 0}, Coord2D{4, 0}, 0.25),
+                                    Boundary::line(Coord2D{4, 0}, Coord2D{4, 4}, 0.25),
+                                    Boundary::line(Coord2D{4, 4}, Coord2D{0, 4}, 0.25),
+                                    Boundary::line(Coord2D{0, 4}, Coord2D{0, 0}, 0.25));
+    auto b = Boundary::combine(square, Boundary::circle(Coord2D{2, 2}, 1, 0.1));
+
+    for(Smoother smoother: {Smoother::laplacian, Smoother::odt}) {
+        Mesh serial{b, 0.25};
+        Mesh parallel{b, 0.25};
+        std::vector<Node> before{serial.get_triangulation().get_nodes()};
+        double area_before{0};
+        for(Triangle& t: serial.get_triangulation().get_triangles()) {
+            area_before += t.get_area();
+        }
+
+        const Delaunay& held = serial.get_triangulation();
+
+        // Quality improves and never gets worse from one iteration to the next
+        std::vector<SmoothingStep> steps{serial.smooth(5, smoother)};
+        ASSERT_GT(steps.size(), 1);
+        ASSERT_EQ(steps[0].iteration, 0);
+        ASSERT_GT(steps[1].moved, 0);
+        for(size_t i{1}; i < steps.size(); i++) {
+            ASSERT_GE(steps[i].min_angle, steps[i-1].min_angle);
+        }
+        ASSERT_GT(steps.back().mean_angle, steps[0].mean_angle);
+
+        // Boundary nodes are fixed and the domain is still covered
+        // References taken before smoothing see the smoothed mesh
+        std::vector<Node> after{held.get_nodes()};
+        const Delaunay& d = serial.get_triangulation();
+        ASSERT_EQ(&held, &d);
+        ASSERT_EQ(before.size(), after.size());
+        for(const std::array<int, 2>& segment: d.get_constraints_index()) {
+            for(int v: segment) {
+                ASSERT_EQ(before[v].get_coords(), after[v].get_coords());
+            }
+        }
+        double area_after{0};
+        for(Triangle& t: d.get_triangles()) {
+            ASSERT_GT(t.get_area(), 0);
+            area_after += t.get_area();
+        }
+        ASSERT_NEAR(area_after, area_before, 1e-9);
+
+        // Flips keep the triangulation Delaunay
+        for(Triangle& t: d.get_triangles()) {
+            std::array<Node, 3> v{t.get_vertices()};
+            for(Node& node: after) {
+                ASSERT_FALSE(in_circumcircle(v[0].get_coords(), v[1].get_coords(), v[2].get_coords(), node.get_coords()));
+            }
+        }
+
+        // Coloring makes the result independent of the number of threads
+        parallel.smooth(5, smoother, true, 3);
+        ASSERT_EQ(d.get_triangles_index(), parallel.get_triangulation().get_triangles_index());
+        std::vector<Node> nodes{parallel.get_triangulation().get_nodes()};
+        for(size_t i{0}; i < nodes.size(); i++) {
+            ASSERT_EQ(nodes[i].get_coords(), after[i].get_coords());
+        }
+    }
+}
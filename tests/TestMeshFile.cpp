@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include <cstdio>
+#include <cmath>
+
+#include <Mesh.hpp>
+#include <MeshFile.hpp>
+
+
+TEST(MeshFileTest, SaveLoad) {
+  double h{0.5};
+  auto wall1 = Boundary::line(Coord2D{0, 0}, Coord2D{4, 0}, h);
+  auto wall2 = Boundary::line(Coord2D{4, 0}, Coord2D{4, 4}, h);
+  auto wall3 = Boundary::line(Coord2D{4, 4}, Coord2D{0, 4}, h);
+  auto wall4 = Boundary::line(Coord2D{0, 4}, Coord2D{0, 0}, h);
+  auto hole = Boundary::circle(Coord2D{2, 2}, 1, 0.2);
+  Mesh msh{Boundary::combine(wall1, wall2, wall3, wall4, hole), h};
+  const Delaunay& d = msh.get_triangulation();
+
+  std::vector<std::array<int, 3>> triangles{d.get_triangles_index()};
+  std::vector<std::array<int, 3>> neighbors{d.get_neighbors_index()};
+  std::vector<std::array<int, 2>> segments{d.get_constraints_index()};
+  std::vector<Node> nodes{d.get_nodes()};
+
+  for(bool adjacency: {true, false}) {
+    std::string filename{"trimesh_test.bin"};
+    d.save(filename, adjacency);
+    {
+      MeshView view{filename};
+      ASSERT_EQ(view.get_nodes_count(), d.get_nodes_count());
+      ASSERT_EQ(view.get_triangles_count(), triangles.size());
+      ASSERT_EQ(view.has_neighbors(), adjacency);
+      for(int v{0}; v < view.get_nodes_count(); v++) {
+        ASSERT_EQ(view.get_node(v), nodes[v].get_coords());
+      }
+      ASSERT_TRUE(std::equal(triangles.begin(), triangles.end(), view.get_triangles_index().begin()));
+      if(adjacency) {
+        ASSERT_TRUE(std::equal(neighbors.begin(), neighbors.end(), view.get_neighbors_index().begin()));
+      } else {
+        ASSERT_TRUE(view.get_neighbors_index().empty());
+      }
+      ASSERT_EQ(view.get_segments_index().size(), segments.size());
+      ASSERT_TRUE(std::equal(segments.begin(), segments.end(), view.get_segments_index().begin()));
+
+      // Modifiable copy
+      Delaunay copy{view.to_delaunay()};
+      ASSERT_EQ(copy.get_triangles_index(), triangles);
+      ASSERT_EQ(copy.get_neighbors_index(), neighbors);
+      ASSERT_EQ(copy.get_constraints_index(), segments);
+    }
+    std::remove(filename.c_str());
+  }
+}
+
+TEST(MeshFileTest, SaveFiltered) {
+  // Super triangle ones are not saved
+  std::vector<Coord2D> points{{0, 0}, {1, 0}, {0, 1}, {1, 1}, {0.4, 0.6}};
+  Delaunay d{points};
+  d.compute();
+
+  std::string filename{"trimesh_test_filtered.bin"};
+  d.save(filename);
+  {
+    MeshView view{filename};
+    std::vector<std::array<int, 3>> triangles{d.get_triangles_index()};
+    std::vector<std::array<int, 3>> neighbors{d.get_neighbors_index()};
+    ASSERT_EQ(view.get_triangles_count(), triangles.size());
+    ASSERT_TRUE(std::equal(triangles.begin(), triangles.end(), view.get_triangles_index().begin()));
+    ASSERT_TRUE(std::equal(neighbors.begin(), neighbors.end(), view.get_neighbors_index().begin()));
+    ASSERT_TRUE(view.get_segments_index().empty());
+  }
+  std::remove(filename.c_str());
+}
+
+TEST(MeshFileTest, InvalidFile) {
+  std::string filename{"trimesh_test_invalid.bin"};
+  {
+    std::ofstream file{filename, std::ios::binary};
+    file << "not a mesh file, but long enough to hold a whole header of the mesh format....";
+  }
+  ASSERT_THROW(MeshView{filename}, std::runtime_error);
+  std::remove(filename.c_str());
+  ASSERT_THROW(MeshView{"missing_mesh_file.bin"}, std::runtime_error);
+}
+
+TEST(MeshFileTest, InvalidIndices) {
+  std::vector<Coord2D> points{{0, 0}, {1, 0}, {0, 1}, {1, 1}};
+  Delaunay d{points};
+  d.compute();
+  std::string filename{"trimesh_test_indices.bin"};
+  d.save(filename, false);
+
+  // Valid header and sections, first triangle vertex out of range
+  MeshFile::Header header;
+  {
+    std::ifstream file{filename, std::ios::binary};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+  }
+  {
+    std::fstream file{filename, std::ios::binary | std::ios::in | std::ios::out};
+    int vertex{static_cast<int>(header.nodes)};
+    file.seekp(header.triangles_offset);
+    file.write(reinterpret_cast<const char*>(&vertex), sizeof(vertex));
+  }
+  {
+    MeshView view{filename};
+    ASSERT_EQ(view.get_triangles_index()[0][0], view.get_nodes_count());
+    ASSERT_THROW(view.to_delaunay(), std::runtime_error);
+  }
+  std::remove(filename.c_str());
+}
@@ -0,0 +1,44 @@
+#include <gtest/gtest.h>
+#include <Delaunay.hpp>
+#include <Predicates.hpp>
+
+#include <cmath>
+
+TEST(PredicatesTest, Orient2d) {
+  Coord2D a{0, 0};
+  Coord2D b{1, 0};
+  Coord2D c{0, 1};
+
+  ASSERT_GT(Predicates::orient2d(a, b, c), 0);
+  ASSERT_LT(Predicates::orient2d(a, c, b), 0);
+  ASSERT_EQ(0, Predicates::orient2d(Coord2D{0, 0}, Coord2D{1, 1}, Coord2D{2, 2}));
+
+  // Nearly collinear points where the rounded determinant has the wrong sign
+  double d{std::ldexp(1.0, -53)};
+  Coord2D p{0.5 + d, 0.5};
+  Coord2D q{12, 12};
+  Coord2D r{24, 24};
+  ASSERT_LT(Predicates::orient2d(p, q, r), 0);
+  ASSERT_LT(Predicates::orient2d_exact(p, q, r), 0);
+  ASSERT_GT(Predicates::orient2d(q, p, r), 0);
+}
+
+TEST(PredicatesTest, Incircle) {
+  Coord2D a{1, 0};
+  Coord2D b{0, 1};
+  Coord2D c{-1, 0};
+
+  ASSERT_GT(Predicates::incircle(a, b, c, Coord2D{0, 0}), 0);
+  ASSERT_LT(Predicates::incircle(a, b, c, Coord2D{2, 0}), 0);
+  ASSERT_LT(Predicates::incircle(a, c, b, Coord2D{0, 0}), 0);
+  ASSERT_EQ(0, Predicates::incircle(a, b, c, Coord2D{0, -1}));
+
+  // Cocircular points far from the origin
+  double o{1e6};
+  ASSERT_EQ(0, Predicates::incircle(Coord2D{o+3, o}, Coord2D{o, o+3}, Coord2D{o-3, o}, Coord2D{o, o-3}));
+  ASSERT_EQ(0, Predicates::incircle_exact(Coord2D{o+3, o}, Coord2D{o, o+3}, Coord2D{o-3, o}, Coord2D{o, o-3}));
+
+  // Query point pushed inside by the smallest representable amount
+  double d{std::ldexp(1.0, -33)};
+  ASSERT_GT(Predicates::incircle(Coord2D{o+3, o}, Coord2D{o, o+3}, Coord2D{o-3, o}, Coord2D{o, o-3+d}), 0);
+}
@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <cmath>
+#include <thread>
+
+#include <Mesh.hpp>
+#include <Stats.hpp>
+
+
+static Boundary cylinder() {
+  return Boundary::combine(Boundary::line(Coord2D{-5, -2.5}, Coord2D{5, -2.5}, 0.5),
+                           Boundary::line(Coord2D{5, -2.5}, Coord2D{5, 2.5}, 0.5),
+                           Boundary::line(Coord2D{5, 2.5}, Coord2D{-5, 2.5}, 0.5),
+                           Boundary::line(Coord2D{-5, 2.5}, Coord2D{-5, -2.5}, 0.5),
+                           Boundary::circle(Coord2D{0, 0}, 1, 0.1));
+}
+
+TEST(StatsTest, Delaunay) {
+  std::mt19937 gen(1);
+  std::uniform_real_distribution<double> dis(0.0, 1.0);
+  std::vector<Coord2D> points;
+  for(int i{0}; i < 1000; i++) {
+    points.push_back(Coord2D{dis(gen), dis(gen)});
+  }
+
+  for(Engine engine: {Engine::bowyer_watson, Engine::lawson}) {
+    Delaunay d{points, engine};
+    d.compute();
+    const Stats& stats{d.get_stats()};
+    if(!Stats::enabled) {
+      ASSERT_EQ(stats.insertions, 0);
+      ASSERT_EQ(stats.compute_ms, 0);
+      continue;
+    }
+    ASSERT_EQ(stats.insertions, 1000);
+    ASSERT_EQ(stats.walks, 1000);
+    ASSERT_GE(stats.walk_steps, stats.walks);
+    ASSERT_GT(stats.circle_tests, 0);
+    ASSERT_GT(stats.orient2d, 0);
+    ASSERT_LE(stats.exact, stats.orient2d + stats.incircle);
+    ASSERT_GE(stats.max_cavity, 1);
+    // Every insertion adds two triangles
+    ASSERT_EQ(stats.triangles_created - stats.triangles_destroyed, 2 * 1000);
+    ASSERT_GT(stats.compute_ms, 0);
+
+    d.reset_stats();
+    ASSERT_EQ(d.get_stats().insertions, 0);
+    d.add_point(Coord2D{0.5, 0.5});
+    ASSERT_EQ(d.get_stats().insertions, 1);
+    ASSERT_EQ(d.get_stats().compute_ms, 0);
+  }
+}
+
+TEST(StatsTest, Refine) {
+  Boundary b{cylinder()};
+  std::vector<Coord2D> points;
+  for(Node& node: b.get_nodes()) {
+    points.push_back(node.get_coords());
+  }
+
+  for(int threads: {1, 2}) {
+    Delaunay d{points, b.get_edges()};
+    d.compute();
+    d.reset_stats();
+    d.refine(30 * M_PI / 180, 0.5, threads);
+    const Stats& stats{d.get_stats()};
+    if(!Stats::enabled) {
+      ASSERT_EQ(stats.quality_points + stats.size_points + stats.segment_splits, 0);
+      continue;
+    }
+    // Every Steiner point and segment split is a node added by the refinement
+    ASSERT_GT(stats.quality_points, 0);
+    ASSERT_GT(stats.size_points, 0);
+    ASSERT_GT(stats.segment_splits, 0);
+    long long added{d.get_nodes_count() - static_cast<long long>(points.size())};
+    ASSERT_EQ(stats.quality_points + stats.size_points + stats.segment_splits, added);
+    ASSERT_EQ(stats.insertions, added);
+    ASSERT_EQ(stats.rescans, 2);
+    ASSERT_GT(stats.walks, 0);
+    ASSERT_GT(stats.refine_quality_ms, 0);
+    ASSERT_GT(stats.refine_size_ms, 0);
+    ASSERT_EQ(stats.compute_ms, 0);
+  }
+}
+
+TEST(StatsTest, Threads) {
+  Boundary b{cylinder()};
+  std::vector<Coord2D> points;
+  for(Node& node: b.get_nodes()) {
+    points.push_back(node.get_coords());
+  }
+  auto refined = [&](int threads) {
+    Delaunay d{points, b.get_edges()};
+    d.compute();
+    d.reset_stats();
+    d.refine(30 * M_PI / 180, 0.2, threads);
+    return d.get_stats();
+  };
+  Stats alone{refined(1)};
+
+  // Predicates of other threads are not counted, even if they end while refining
+  std::mt19937 gen(3);
+  std::uniform_real_distribution<double> dis(0.0, 1.0);
+  std::vector<Coord2D> other;
+  for(int i{0}; i < 2000; i++) {
+    other.push_back(Coord2D{dis(gen), dis(gen)});
+  }
+  std::thread background{[&]() {
+    Delaunay d{other};
+    d.compute();
+  }};
+  Stats concurrent{refined(1)};
+  background.join();
+  ASSERT_EQ(concurrent.orient2d, alone.orient2d);
+  ASSERT_EQ(concurrent.incircle, alone.incircle);
+  ASSERT_EQ(concurrent.circle_tests, alone.circle_tests);
+
+  // Workers report their counts: rounds do the same work with any number of threads
+  Stats two{refined(2)};
+  Stats three{refined(3)};
+  ASSERT_EQ(two.orient2d, three.orient2d);
+  ASSERT_EQ(two.circle_tests, three.circle_tests);
+  if(Stats::enabled) {
+    ASSERT_GT(two.circle_tests, 0);
+  }
+}
+
+TEST(StatsTest, Mesh) {
+  Mesh msh{cylinder(), 0.5};
+  msh.get_triangulation();
+  Stats stats{msh.get_stats()};
+  std::string json{stats.json()};
+  ASSERT_EQ(json.front(), '{');
+  ASSERT_EQ(json.back(), '}');
+  if(!Stats::enabled) {
+    ASSERT_NE(json.find("\"enabled\": false"), std::string::npos);
+    ASSERT_EQ(stats.combine_ms, 0);
+    return;
+  }
+  ASSERT_NE(json.find("\"enabled\": true"), std::string::npos);
+  ASSERT_NE(json.find("\"refine_quality\": "), std::string::npos);
+  ASSERT_GT(stats.quality_points + stats.size_points, 0);
+  ASSERT_GT(stats.compute_ms, 0);
+  ASSERT_GT(stats.get_triangulation_ms, 0);
+  ASSERT_GT(stats.combine_ms, 0);
+}